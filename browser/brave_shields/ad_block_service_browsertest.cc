@@ -70,6 +70,7 @@ const char kRegionalAdBlockComponentTest64PublicKey[] =
 
 using brave_shields::features::kBraveAdblockCnameUncloaking;
 using brave_shields::features::kBraveAdblockCosmeticFiltering;
+using brave_shields::features::kBraveAdblockCosmeticFilteringNative;
 using content::BrowserThread;
 
 void AdBlockServiceTest::SetUpOnMainThread() {
@@ -1519,3 +1520,109 @@ IN_PROC_BROWSER_TEST_F(AdBlockServiceTest, CosmeticFilteringIframeScriptlet) {
 
   ASSERT_EQ(true, EvalJs(contents, "show_ad"));
 }
+
+class CosmeticFilteringNativeTest : public AdBlockServiceTest {
+ public:
+  CosmeticFilteringNativeTest() {
+    feature_list_.InitAndEnableFeature(kBraveAdblockCosmeticFilteringNative);
+  }
+
+  bool WaitForSelector(content::WebContents* contents,
+                       const std::string& selector,
+                       const std::string& property,
+                       const std::string& expected) {
+    const char kWaitCSSSelectorScript[] = R"(function waitCSSSelector() {
+          if (checkSelector($1, $2, $3)) {
+            window.domAutomationController.send(true);
+          } else {
+            console.log('still waiting for css selector');
+            setTimeout(waitCSSSelector, 200);
+          }
+        } waitCSSSelector())";
+    auto result = EvalJsWithManualReply(
+        contents, content::JsReplace(kWaitCSSSelectorScript, selector,
+                                     property, expected));
+    return result.error.empty() && result.value == base::Value(true);
+  }
+
+ private:
+  base::test::ScopedFeatureList feature_list_;
+};
+
+// Test url-specific and generic hide rules applied by the renderer
+IN_PROC_BROWSER_TEST_F(CosmeticFilteringNativeTest, CosmeticFilteringSimple) {
+  UpdateAdBlockInstanceWithRules(
+      "b.com###ad-banner\n"
+      "##.ad");
+
+  GURL tab_url =
+      embedded_test_server()->GetURL("b.com", "/cosmetic_filtering.html");
+  ui_test_utils::NavigateToURL(browser(), tab_url);
+
+  content::WebContents* contents =
+      browser()->tab_strip_model()->GetActiveWebContents();
+
+  EXPECT_TRUE(WaitForSelector(contents, "#ad-banner", "display", "none"));
+  EXPECT_TRUE(WaitForSelector(contents, ".ad-banner", "display", "block"));
+  EXPECT_TRUE(WaitForSelector(contents, ".ad", "display", "none"));
+}
+
+// Test url-specific custom filter rules, which are force hidden
+IN_PROC_BROWSER_TEST_F(CosmeticFilteringNativeTest,
+                       CosmeticFilteringCustomHide) {
+  UpdateAdBlockInstanceWithRules("");
+  ASSERT_TRUE(g_brave_browser_process->ad_block_custom_filters_service()
+                  ->UpdateCustomFilters("b.com###ad-banner"));
+
+  GURL tab_url =
+      embedded_test_server()->GetURL("b.com", "/cosmetic_filtering.html");
+  ui_test_utils::NavigateToURL(browser(), tab_url);
+
+  content::WebContents* contents =
+      browser()->tab_strip_model()->GetActiveWebContents();
+
+  EXPECT_TRUE(WaitForSelector(contents, "#ad-banner", "display", "none"));
+}
+
+// Test style rules applied by the renderer
+IN_PROC_BROWSER_TEST_F(CosmeticFilteringNativeTest,
+                       CosmeticFilteringCustomStyle) {
+  UpdateAdBlockInstanceWithRules("b.com##.ad:style(padding-bottom: 10px)");
+
+  GURL tab_url =
+      embedded_test_server()->GetURL("b.com", "/cosmetic_filtering.html");
+  ui_test_utils::NavigateToURL(browser(), tab_url);
+
+  content::WebContents* contents =
+      browser()->tab_strip_model()->GetActiveWebContents();
+
+  EXPECT_TRUE(WaitForSelector(contents, ".ad", "padding-bottom", "10px"));
+}
+
+// Test scriptlet injection by the renderer
+IN_PROC_BROWSER_TEST_F(CosmeticFilteringNativeTest,
+                       CosmeticFilteringScriptlet) {
+  std::string scriptlet =
+      "(function() {"
+      "  window.JSON.parse = function() { return {} }"
+      "})();";
+  std::string scriptlet_base64;
+  base::Base64Encode(scriptlet, &scriptlet_base64);
+  UpdateAdBlockInstanceWithRules(
+      "b.com##+js(hjt)",
+      "[{"
+      "\"name\": \"hijacktest\","
+      "\"aliases\": [\"hjt\"],"
+      "\"kind\": {\"mime\": \"application/javascript\"},"
+      "\"content\": \"" +
+          scriptlet_base64 + "\"}]");
+
+  GURL tab_url =
+      embedded_test_server()->GetURL("b.com", "/iframe_messenger.html");
+  ui_test_utils::NavigateToURL(browser(), tab_url);
+
+  content::WebContents* contents =
+      browser()->tab_strip_model()->GetActiveWebContents();
+
+  ASSERT_EQ(true, EvalJs(contents, "show_ad"));
+}
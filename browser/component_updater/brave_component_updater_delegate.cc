@@ -21,8 +21,11 @@ using brave_component_updater::BraveOnDemandUpdater;
 namespace brave {
 
 BraveComponentUpdaterDelegate::BraveComponentUpdaterDelegate()
+    // The ad block service waits on this sequence for engines matched
+    // concurrently on the thread pool.
     : task_runner_(base::ThreadPool::CreateSequencedTaskRunner(
-          {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+          {base::MayBlock(), base::WithBaseSyncPrimitives(),
+           base::TaskPriority::USER_VISIBLE,
            base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN})) {}
 
 BraveComponentUpdaterDelegate::~BraveComponentUpdaterDelegate() {}
@@ -5,7 +5,9 @@
 
 #include "brave/browser/extensions/api/brave_shields_api.h"
 
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "base/feature_list.h"
 #include "base/strings/string_number_conversions.h"
@@ -45,6 +47,32 @@ namespace {
 const char kInvalidUrlError[] = "Invalid URL.";
 const char kInvalidControlTypeError[] = "Invalid ControlType.";
 
+base::Value ListValueFromStrings(const std::vector<std::string>& strings) {
+  base::Value list(base::Value::Type::LIST);
+  for (const auto& string : strings)
+    list.Append(string);
+  return list;
+}
+
+base::Value CosmeticResourcesToValue(
+    const ::brave_shields::CosmeticResources& resources) {
+  base::Value style_selectors(base::Value::Type::DICTIONARY);
+  for (const auto& style : resources.style_selectors) {
+    style_selectors.SetKey(style.first, ListValueFromStrings(style.second));
+  }
+
+  base::Value value(base::Value::Type::DICTIONARY);
+  value.SetKey("hide_selectors",
+               ListValueFromStrings(resources.hide_selectors));
+  value.SetKey("style_selectors", std::move(style_selectors));
+  value.SetKey("exceptions", ListValueFromStrings(resources.exceptions));
+  value.SetStringKey("injected_script", resources.injected_script);
+  value.SetBoolKey("generichide", resources.generichide);
+  value.SetKey("force_hide_selectors",
+               ListValueFromStrings(resources.force_hide_selectors));
+  return value;
+}
+
 }  // namespace
 
 ExtensionFunction::ResponseAction
@@ -68,15 +96,11 @@ BraveShieldsUrlCosmeticResourcesFunction::Run() {
 std::unique_ptr<base::ListValue>
 BraveShieldsUrlCosmeticResourcesFunction::GetUrlCosmeticResourcesOnTaskRunner(
     const std::string& url) {
-  base::Optional<base::Value> resources =
-      g_brave_browser_process->ad_block_service()->UrlCosmeticResources(url);
-
-  if (!resources || !resources->is_dict()) {
-    return std::unique_ptr<base::ListValue>();
-  }
-
   auto result_list = std::make_unique<base::ListValue>();
-  result_list->Append(std::move(*resources));
+  result_list->Append(CosmeticResourcesToValue(
+      g_brave_browser_process->ad_block_service()
+          ->SharedUrlCosmeticResources(url)
+          ->data));
   return result_list;
 }
 
@@ -113,15 +137,27 @@ std::unique_ptr<base::ListValue> BraveShieldsHiddenClassIdSelectorsFunction::
         const std::vector<std::string>& classes,
         const std::vector<std::string>& ids,
         const std::vector<std::string>& exceptions) {
-  base::Optional<base::Value> hide_selectors =
-      g_brave_browser_process->ad_block_service()->HiddenClassIdSelectors(
-          classes, ids, exceptions);
+  std::vector<std::string> hide_selectors;
+  std::vector<std::string> force_hide_selectors;
+  g_brave_browser_process->ad_block_service()->HiddenClassIdSelectors(
+      classes, ids, exceptions, &hide_selectors, &force_hide_selectors);
+
+  auto result_list = std::make_unique<base::ListValue>();
 
-  if (!hide_selectors || !hide_selectors->is_list())
-    return std::make_unique<base::ListValue>();
+#if !defined(OS_ANDROID) && !defined(CHROME_OS)
+  if (!base::FeatureList::IsEnabled(
+          ::brave_shields::features::kBraveAdblockCosmeticFilteringNative)) {
+    result_list->Append(ListValueFromStrings(std::move(hide_selectors)));
+    result_list->Append(ListValueFromStrings(std::move(force_hide_selectors)));
+    return result_list;
+  }
+#endif
 
-  auto result_list =
-      std::make_unique<base::ListValue>(hide_selectors->GetList());
+  // The selectors from custom filters stay a nested list at the end, as they
+  // were in the JSON result.
+  for (auto& selector : hide_selectors)
+    result_list->Append(std::move(selector));
+  result_list->Append(ListValueFromStrings(std::move(force_hide_selectors)));
 
   return result_list;
 }
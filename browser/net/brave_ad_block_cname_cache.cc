@@ -0,0 +1,65 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/brave_ad_block_cname_cache.h"
+
+#include "base/time/tick_clock.h"
+
+namespace brave {
+
+AdBlockCnameCache::AdBlockCnameCache(size_t size, const base::TickClock* clock)
+    : entries_(size), clock_(clock) {
+  DCHECK(clock_);
+}
+
+AdBlockCnameCache::~AdBlockCnameCache() = default;
+
+bool AdBlockCnameCache::Get(
+    const net::NetworkIsolationKey& network_isolation_key,
+    const std::string& host,
+    std::string* canonical_name) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(canonical_name);
+
+  auto it = entries_.Get(Key(network_isolation_key, host));
+  if (it != entries_.end()) {
+    if (it->second.expiration > clock_->NowTicks()) {
+      *canonical_name = it->second.canonical_name;
+      stats_.hits++;
+      return true;
+    }
+    entries_.Erase(it);
+  }
+
+  stats_.misses++;
+  return false;
+}
+
+void AdBlockCnameCache::Put(
+    const net::NetworkIsolationKey& network_isolation_key,
+    const std::string& host,
+    const std::string& canonical_name,
+    base::TimeDelta ttl) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  entries_.Put(Key(network_isolation_key, host),
+               {canonical_name, clock_->NowTicks() + ttl});
+}
+
+void AdBlockCnameCache::Clear() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  entries_.Clear();
+}
+
+AdBlockCnameCache::Stats AdBlockCnameCache::stats() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return stats_;
+}
+
+base::WeakPtr<AdBlockCnameCache> AdBlockCnameCache::AsWeakPtr() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return weak_factory_.GetWeakPtr();
+}
+
+}  // namespace brave
@@ -0,0 +1,81 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_BROWSER_NET_BRAVE_AD_BLOCK_CNAME_CACHE_H_
+#define BRAVE_BROWSER_NET_BRAVE_AD_BLOCK_CNAME_CACHE_H_
+
+#include <string>
+#include <utility>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
+#include "base/supports_user_data.h"
+#include "base/time/time.h"
+#include "net/base/network_isolation_key.h"
+
+namespace base {
+class TickClock;
+}  // namespace base
+
+namespace brave {
+
+// MRU cache of the canonical names that hosts resolved to during CNAME
+// uncloaking. Hosts without a CNAME record are cached too, with their own
+// name as the canonical name, so that they are not resolved over and over.
+// Hosts are cached per network isolation key, as they are resolved, and each
+// browser context gets its own cache.
+class AdBlockCnameCache : public base::SupportsUserData::Data {
+ public:
+  struct Stats {
+    size_t hits;
+    size_t misses;
+  };
+
+  // |clock| must outlive the cache.
+  AdBlockCnameCache(size_t size, const base::TickClock* clock);
+  ~AdBlockCnameCache() override;
+
+  // Copies the canonical name cached for |host| into |canonical_name| and
+  // returns true, unless there is none or it has expired.
+  bool Get(const net::NetworkIsolationKey& network_isolation_key,
+           const std::string& host,
+           std::string* canonical_name);
+
+  // Caches |canonical_name| for |host| for the next |ttl|.
+  void Put(const net::NetworkIsolationKey& network_isolation_key,
+           const std::string& host,
+           const std::string& canonical_name,
+           base::TimeDelta ttl);
+
+  void Clear();
+
+  Stats stats() const;
+
+  base::WeakPtr<AdBlockCnameCache> AsWeakPtr();
+
+ private:
+  using Key = std::pair<net::NetworkIsolationKey, std::string>;
+
+  struct Entry {
+    std::string canonical_name;
+    base::TimeTicks expiration;
+  };
+
+  base::MRUCache<Key, Entry> entries_;
+  const base::TickClock* clock_;
+  Stats stats_ = {0, 0};
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  base::WeakPtrFactory<AdBlockCnameCache> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockCnameCache);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_NET_BRAVE_AD_BLOCK_CNAME_CACHE_H_
@@ -0,0 +1,107 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <string>
+
+#include "base/test/simple_test_tick_clock.h"
+#include "brave/browser/net/brave_ad_block_cname_cache.h"
+#include "net/base/schemeful_site.h"
+#include "url/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave {
+
+TEST(AdBlockCnameCacheTest, GetAndPut) {
+  base::SimpleTestTickClock clock;
+  AdBlockCnameCache cache(10, &clock);
+  const net::NetworkIsolationKey key;
+  std::string canonical_name;
+
+  EXPECT_FALSE(cache.Get(key, "a.com", &canonical_name));
+  cache.Put(key, "a.com", "tracker.com", base::TimeDelta::FromMinutes(1));
+  EXPECT_TRUE(cache.Get(key, "a.com", &canonical_name));
+  EXPECT_EQ("tracker.com", canonical_name);
+  EXPECT_FALSE(cache.Get(key, "b.com", &canonical_name));
+
+  AdBlockCnameCache::Stats stats = cache.stats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+}
+
+TEST(AdBlockCnameCacheTest, HostWithoutCname) {
+  base::SimpleTestTickClock clock;
+  AdBlockCnameCache cache(10, &clock);
+  const net::NetworkIsolationKey key;
+  std::string canonical_name;
+
+  cache.Put(key, "a.com", "a.com", base::TimeDelta::FromMinutes(1));
+  EXPECT_TRUE(cache.Get(key, "a.com", &canonical_name));
+  EXPECT_EQ("a.com", canonical_name);
+}
+
+TEST(AdBlockCnameCacheTest, KeyedByNetworkIsolationKey) {
+  base::SimpleTestTickClock clock;
+  AdBlockCnameCache cache(10, &clock);
+  std::string canonical_name;
+
+  const net::SchemefulSite site_a(GURL("https://a.test"));
+  const net::SchemefulSite site_b(GURL("https://b.test"));
+  const net::NetworkIsolationKey key_a(site_a, site_a);
+  const net::NetworkIsolationKey key_b(site_b, site_b);
+
+  cache.Put(key_a, "c.com", "tracker.com", base::TimeDelta::FromMinutes(1));
+  EXPECT_TRUE(cache.Get(key_a, "c.com", &canonical_name));
+  EXPECT_FALSE(cache.Get(key_b, "c.com", &canonical_name));
+  EXPECT_FALSE(
+      cache.Get(net::NetworkIsolationKey(), "c.com", &canonical_name));
+}
+
+TEST(AdBlockCnameCacheTest, EntriesExpire) {
+  base::SimpleTestTickClock clock;
+  AdBlockCnameCache cache(10, &clock);
+  const net::NetworkIsolationKey key;
+  std::string canonical_name;
+
+  cache.Put(key, "a.com", "tracker.com", base::TimeDelta::FromSeconds(60));
+  clock.Advance(base::TimeDelta::FromSeconds(59));
+  EXPECT_TRUE(cache.Get(key, "a.com", &canonical_name));
+  clock.Advance(base::TimeDelta::FromSeconds(1));
+  EXPECT_FALSE(cache.Get(key, "a.com", &canonical_name));
+
+  // Caching the host again starts a new TTL.
+  cache.Put(key, "a.com", "other-tracker.com",
+            base::TimeDelta::FromSeconds(60));
+  EXPECT_TRUE(cache.Get(key, "a.com", &canonical_name));
+  EXPECT_EQ("other-tracker.com", canonical_name);
+}
+
+TEST(AdBlockCnameCacheTest, EvictsLeastRecentlyUsed) {
+  base::SimpleTestTickClock clock;
+  AdBlockCnameCache cache(2, &clock);
+  const net::NetworkIsolationKey key;
+  std::string canonical_name;
+
+  cache.Put(key, "a.com", "a.com", base::TimeDelta::FromMinutes(1));
+  cache.Put(key, "b.com", "b.com", base::TimeDelta::FromMinutes(1));
+  EXPECT_TRUE(cache.Get(key, "a.com", &canonical_name));
+  cache.Put(key, "c.com", "c.com", base::TimeDelta::FromMinutes(1));
+
+  EXPECT_TRUE(cache.Get(key, "a.com", &canonical_name));
+  EXPECT_FALSE(cache.Get(key, "b.com", &canonical_name));
+  EXPECT_TRUE(cache.Get(key, "c.com", &canonical_name));
+}
+
+TEST(AdBlockCnameCacheTest, Clear) {
+  base::SimpleTestTickClock clock;
+  AdBlockCnameCache cache(10, &clock);
+  const net::NetworkIsolationKey key;
+  std::string canonical_name;
+
+  cache.Put(key, "a.com", "tracker.com", base::TimeDelta::FromMinutes(1));
+  cache.Clear();
+  EXPECT_FALSE(cache.Get(key, "a.com", &canonical_name));
+}
+
+}  // namespace brave
@@ -7,6 +7,7 @@
 
 #include <string>
 
+#include "base/trace_event/trace_event.h"
 #include "brave/browser/brave_browser_process.h"
 #include "brave/browser/net/url_context.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
@@ -19,7 +20,11 @@ namespace brave {
 
 base::Optional<std::string> GetCspDirectivesOnTaskRunner(
     std::shared_ptr<BraveRequestInfo> ctx,
-    base::Optional<std::string> original_csp) {
+    base::Optional<std::string> original_csp,
+    base::TimeTicks posted_time) {
+  RecordTaskQueueTime("Brave.OnHeadersReceived_AdBlockCsp.TaskQueueTime",
+                      posted_time);
+  TRACE_EVENT0("net", "GetCspDirectivesOnTaskRunner");
   std::string source_host;
   if (ctx->initiator_url.is_valid() && !ctx->initiator_url.host().empty()) {
     source_host = ctx->initiator_url.host();
@@ -92,7 +97,8 @@ int OnHeadersReceived_AdBlockCspWork(
 
     task_runner->PostTaskAndReplyWithResult(
         FROM_HERE,
-        base::BindOnce(&GetCspDirectivesOnTaskRunner, ctx, original_csp),
+        base::BindOnce(&GetCspDirectivesOnTaskRunner, ctx, original_csp,
+                       base::TimeTicks::Now()),
         base::BindOnce(&OnReceiveCspDirectives, next_callback, ctx,
                        *override_response_headers));
     return net::ERR_IO_PENDING;
@@ -12,9 +12,14 @@
 
 #include "base/base64url.h"
 #include "base/feature_list.h"
+#include "base/memory/weak_ptr.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/strings/string_util.h"
+#include "base/time/default_tick_clock.h"
+#include "base/trace_event/trace_event.h"
 #include "brave/browser/brave_browser_process.h"
 #include "brave/browser/brave_shields/brave_shields_web_contents_observer.h"
+#include "brave/browser/net/brave_ad_block_cname_cache.h"
 #include "brave/browser/net/url_context.h"
 #include "brave/common/network_constants.h"
 #include "brave/common/url_constants.h"
@@ -53,12 +58,52 @@ void SetAdblockCnameHostResolverForTesting(
   g_testing_host_resolver = host_resolver;
 }
 
+namespace {
+
+constexpr size_t kCnameCacheSize = 1000;
+// ResolveHostClient doesn't get to see the TTL of the records it resolved, so
+// this mirrors what the network service's HostCache uses for results of the
+// system resolver.
+constexpr base::TimeDelta kCnameCacheEntryTtl = base::TimeDelta::FromMinutes(1);
+
+const char kCnameCacheUserDataKey[] = "brave_adblock_cname_cache";
+
+// Each browser context caches the results of its own resolutions, so that
+// they go away with it. Only used on the UI thread.
+AdBlockCnameCache* GetCnameCache(content::BrowserContext* browser_context) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  DCHECK(browser_context);
+
+  auto* cache = static_cast<AdBlockCnameCache*>(
+      browser_context->GetUserData(kCnameCacheUserDataKey));
+  if (!cache) {
+    auto new_cache = std::make_unique<AdBlockCnameCache>(
+        kCnameCacheSize, base::DefaultTickClock::GetInstance());
+    cache = new_cache.get();
+    browser_context->SetUserData(kCnameCacheUserDataKey, std::move(new_cache));
+  }
+
+  return cache;
+}
+
+}  // namespace
+
+AdBlockCnameCache* GetAdblockCnameCacheForTesting(
+    content::BrowserContext* browser_context) {
+  return GetCnameCache(browser_context);
+}
+
 // Used to keep track of state between a primary adblock engine query and one
 // after CNAME uncloaking the request.
 struct EngineFlags {
   bool did_match_rule = false;
   bool did_match_exception = false;
   bool did_match_important = false;
+  std::string mock_data_url;
+
+  bool ShouldBlock() const {
+    return did_match_important || (did_match_rule && !did_match_exception);
+  }
 };
 
 void UseCnameResult(scoped_refptr<base::SequencedTaskRunner> task_runner,
@@ -72,6 +117,9 @@ class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
   mojo::Receiver<network::mojom::ResolveHostClient> receiver_{this};
   base::OnceCallback<void(base::Optional<std::string>)> cb_;
   base::TimeTicks start_time_;
+  std::string host_;
+  net::NetworkIsolationKey network_isolation_key_;
+  base::WeakPtr<AdBlockCnameCache> cache_;
 
  public:
   AdblockCnameResolveHostClient(
@@ -82,6 +130,9 @@ class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
     DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
     cb_ = base::BindOnce(&UseCnameResult, task_runner, std::move(next_callback),
                          ctx, previous_result);
+    host_ = ctx->request_url.host();
+    network_isolation_key_ = ctx->network_isolation_key;
+    cache_ = GetCnameCache(ctx->browser_context)->AsWeakPtr();
 
     const auto network_isolation_key = ctx->network_isolation_key;
 
@@ -99,6 +150,8 @@ class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
       optional_parameters->source = net::HostResolverSource::DNS;
 
     start_time_ = base::TimeTicks::Now();
+    TRACE_EVENT_NESTABLE_ASYNC_BEGIN0("net", "AdblockCnameResolveHost",
+                                      TRACE_ID_LOCAL(this));
 
     if (g_testing_host_resolver) {
       g_testing_host_resolver->ResolveHost(
@@ -136,8 +189,17 @@ class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
       const base::Optional<net::AddressList>& resolved_addresses) override {
     UMA_HISTOGRAM_TIMES("Brave.ShieldsCNAMEBlocking.TotalResolutionTime",
                         base::TimeTicks::Now() - start_time_);
+    TRACE_EVENT_NESTABLE_ASYNC_END1("net", "AdblockCnameResolveHost",
+                                    TRACE_ID_LOCAL(this), "result", result);
     if (result == net::OK && resolved_addresses) {
       DCHECK(resolved_addresses.has_value() && !resolved_addresses->empty());
+      // Hosts without a CNAME record resolve to their own name, and are cached
+      // as well. The browser context may have gone away in the meantime.
+      if (cache_) {
+        cache_->Put(network_isolation_key_, host_,
+                    resolved_addresses->GetCanonicalName(),
+                    kCnameCacheEntryTtl);
+      }
       std::move(cb_).Run(
           base::Optional<std::string>(resolved_addresses->GetCanonicalName()));
     } else {
@@ -158,35 +220,23 @@ class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
   }
 };
 
-// If `canonical_url` is specified, this will only check if the CNAME-uncloaked
-// response should be blocked. Otherwise, it will run the check for the
-// original request URL.
+// Checks `url` against the adblock engines, accumulating the results into
+// `previous_result`. This runs on the adblock task runner, so it only gets
+// copies of what it needs from the request and leaves updating the request to
+// the UI thread, where other helpers may be running concurrently.
 EngineFlags ShouldBlockRequestOnTaskRunner(
-    std::shared_ptr<BraveRequestInfo> ctx,
+    const GURL& url,
+    blink::mojom::ResourceType resource_type,
+    const std::string& source_host,
     EngineFlags previous_result,
-    base::Optional<GURL> canonical_url) {
-  if (!ctx->initiator_url.is_valid()) {
-    return previous_result;
-  }
-  const std::string source_host = ctx->initiator_url.host();
-
-  GURL url_to_check;
-  if (canonical_url.has_value()) {
-    url_to_check = *canonical_url;
-  } else {
-    url_to_check = ctx->request_url;
-  }
-
+    base::TimeTicks posted_time) {
+  RecordTaskQueueTime("Brave.OnBeforeURLRequest_AdBlockTP.TaskQueueTime",
+                      posted_time);
+  TRACE_EVENT0("net", "ShouldBlockRequestOnTaskRunner");
   g_brave_browser_process->ad_block_service()->ShouldStartRequest(
-      url_to_check, ctx->resource_type, source_host,
-      &previous_result.did_match_rule, &previous_result.did_match_exception,
-      &previous_result.did_match_important, &ctx->mock_data_url);
-
-  if (previous_result.did_match_important ||
-      (previous_result.did_match_rule &&
-       !previous_result.did_match_exception)) {
-    ctx->blocked_by = kAdBlocked;
-  }
+      url, resource_type, source_host, &previous_result.did_match_rule,
+      &previous_result.did_match_exception,
+      &previous_result.did_match_important, &previous_result.mock_data_url);
 
   return previous_result;
 }
@@ -198,13 +248,31 @@ void OnShouldBlockRequestResult(
     std::shared_ptr<BraveRequestInfo> ctx,
     EngineFlags result) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-  if (ctx->blocked_by == kAdBlocked) {
+  if (!result.mock_data_url.empty()) {
+    ctx->mock_data_url = result.mock_data_url;
+  }
+  if (result.ShouldBlock()) {
+    // Other helpers may have blocked the request in the meantime, in which
+    // case their reason takes precedence, as if they had run after us.
+    if (ctx->blocked_by == kNotBlocked) {
+      ctx->blocked_by = kAdBlocked;
+    }
     brave_shields::BraveShieldsWebContentsObserver::DispatchBlockedEvent(
         ctx->request_url, ctx->frame_tree_node_id, brave_shields::kAds);
   } else if (then_check_uncloaked) {
+    std::string canonical_name;
+    const bool cache_hit = GetCnameCache(ctx->browser_context)
+                               ->Get(ctx->network_isolation_key,
+                                     ctx->request_url.host(), &canonical_name);
+    UMA_HISTOGRAM_BOOLEAN("Brave.ShieldsCNAMEBlocking.CacheHit", cache_hit);
+    if (cache_hit) {
+      UseCnameResult(task_runner, next_callback, ctx, std::move(result),
+                     canonical_name);
+      return;
+    }
     // This will be deleted by `AdblockCnameResolveHostClient::OnComplete`.
     new AdblockCnameResolveHostClient(std::move(next_callback), task_runner,
-                                      ctx, result);
+                                      ctx, std::move(result));
     return;
   }
   next_callback.Run();
@@ -226,8 +294,9 @@ void UseCnameResult(scoped_refptr<base::SequencedTaskRunner> task_runner,
 
     task_runner->PostTaskAndReplyWithResult(
         FROM_HERE,
-        base::BindOnce(&ShouldBlockRequestOnTaskRunner, ctx, previous_result,
-                       base::make_optional<GURL>(canonical_url)),
+        base::BindOnce(&ShouldBlockRequestOnTaskRunner, canonical_url,
+                       ctx->resource_type, ctx->initiator_url.host(),
+                       std::move(previous_result), base::TimeTicks::Now()),
         base::BindOnce(&OnShouldBlockRequestResult, false, task_runner,
                        next_callback, ctx));
   } else {
@@ -291,8 +360,9 @@ void OnBeforeURLRequestAdBlockTP(const ResponseCallback& next_callback,
 
   task_runner->PostTaskAndReplyWithResult(
       FROM_HERE,
-      base::BindOnce(&ShouldBlockRequestOnTaskRunner, ctx, EngineFlags(),
-                     base::nullopt),
+      base::BindOnce(&ShouldBlockRequestOnTaskRunner, ctx->request_url,
+                     ctx->resource_type, ctx->initiator_url.host(),
+                     EngineFlags(), base::TimeTicks::Now()),
       base::BindOnce(&OnShouldBlockRequestResult, should_check_uncloaked,
                      task_runner, next_callback, ctx));
 }
@@ -303,8 +373,9 @@ int OnBeforeURLRequest_AdBlockTPPreWork(const ResponseCallback& next_callback,
   // be looked up, so do nothing.
   if (ctx->request_url.is_empty() ||
       ctx->request_url.SchemeIs(content::kChromeDevToolsScheme) ||
-      ctx->initiator_url.is_empty() || !ctx->initiator_url.has_host() ||
-      !ctx->allow_brave_shields || ctx->allow_ads ||
+      ctx->initiator_url.is_empty() || !ctx->initiator_url.is_valid() ||
+      !ctx->initiator_url.has_host() || !ctx->allow_brave_shields ||
+      ctx->allow_ads ||
       ctx->resource_type == BraveRequestInfo::kInvalidResourceType) {
     return net::OK;
   }
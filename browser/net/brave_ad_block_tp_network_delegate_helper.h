@@ -10,12 +10,18 @@
 
 #include "brave/browser/net/url_context.h"
 
+namespace content {
+class BrowserContext;
+}  // namespace content
+
 namespace network {
 class HostResolver;
 }  // namespace network
 
 namespace brave {
 
+class AdBlockCnameCache;
+
 int OnBeforeURLRequest_AdBlockTPPreWork(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx);
@@ -25,6 +31,10 @@ int OnBeforeURLRequest_AdBlockTPPreWork(
 void SetAdblockCnameHostResolverForTesting(
     network::HostResolver* host_resolver);
 
+// Returns the cache of CNAME uncloaking results for |browser_context|.
+AdBlockCnameCache* GetAdblockCnameCacheForTesting(
+    content::BrowserContext* browser_context);
+
 }  // namespace brave
 
 #endif  // BRAVE_BROWSER_NET_BRAVE_AD_BLOCK_TP_NETWORK_DELEGATE_HELPER_H_
@@ -9,12 +9,18 @@
 #include <string>
 #include <utility>
 
-#include "base/threading/thread_task_runner_handle.h"
 #include "brave/browser/brave_browser_process.h"
+#include "brave/browser/net/brave_ad_block_cname_cache.h"
 #include "brave/browser/net/url_context.h"
 #include "brave/common/network_constants.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/test/base/testing_brave_browser_process.h"
+#include "brave/test/base/testing_brave_component_updater_delegate.h"
+#include "chrome/browser/net/stub_resolver_config_reader.h"
+#include "chrome/browser/net/system_network_context_manager.h"
+#include "chrome/test/base/scoped_testing_local_state.h"
+#include "chrome/test/base/testing_browser_process.h"
+#include "chrome/test/base/testing_profile.h"
 #include "content/public/test/browser_task_environment.h"
 #include "net/base/net_errors.h"
 #include "net/dns/mock_host_resolver.h"
@@ -24,49 +30,6 @@
 
 using brave::ResponseCallback;
 
-namespace {
-
-// Note: extract a common impl if needed for other tests, do not copy.
-
-// TODO(iefremov): This is only needed to provide a task runner to the adblock
-// service. We can drop this stub once the service doesn't need an
-// "external" runner.
-class TestingBraveComponentUpdaterDelegate : public BraveComponent::Delegate {
- public:
-  TestingBraveComponentUpdaterDelegate() = default;
-  ~TestingBraveComponentUpdaterDelegate() override = default;
-
-  TestingBraveComponentUpdaterDelegate(TestingBraveComponentUpdaterDelegate&) =
-      delete;
-  TestingBraveComponentUpdaterDelegate& operator=(
-      TestingBraveComponentUpdaterDelegate&) = delete;
-
-  using ComponentObserver = update_client::UpdateClient::Observer;
-
-  // brave_component_updater::BraveComponent::Delegate implementation
-  void Register(const std::string& component_name,
-                const std::string& component_base64_public_key,
-                base::OnceClosure registered_callback,
-                BraveComponent::ReadyCallback ready_callback) override {}
-  bool Unregister(const std::string& component_id) override { return true; }
-  void OnDemandUpdate(const std::string& component_id) override {}
-
-  void AddObserver(ComponentObserver* observer) override {}
-  void RemoveObserver(ComponentObserver* observer) override {}
-
-  scoped_refptr<base::SequencedTaskRunner> GetTaskRunner() override {
-    return base::ThreadTaskRunnerHandle::Get();
-  }
-
-  const std::string locale() const override { return "en"; }
-  PrefService* local_state() override {
-    NOTREACHED();
-    return nullptr;
-  }
-};
-
-}  // namespace
-
 class BraveAdBlockTPNetworkDelegateHelperTest : public testing::Test {
  protected:
   void SetUp() override {
@@ -173,3 +136,99 @@ TEST_F(BraveAdBlockTPNetworkDelegateHelperTest, SimpleBlocking) {
   // made (`browser_context` is `nullptr`).
   EXPECT_EQ(0ULL, host_resolver_->num_resolve());
 }
+
+TEST_F(BraveAdBlockTPNetworkDelegateHelperTest, CnameUncloakingIsCached) {
+  ScopedTestingLocalState local_state(TestingBrowserProcess::GetGlobal());
+  StubResolverConfigReader stub_resolver_config_reader(local_state.Get());
+  SystemNetworkContextManager::set_stub_resolver_config_reader_for_testing(
+      &stub_resolver_config_reader);
+  TestingProfile profile;
+
+  ResetAdblockInstance(g_brave_browser_process->ad_block_service(),
+                       "||tracker.com^", "");
+  host_resolver_->rules()->AddIPLiteralRule("cloaked.brave.com", "1.2.3.4",
+                                            "tracker.com");
+  host_resolver_->rules()->AddIPLiteralRule("plain.brave.com", "1.2.3.5",
+                                            "plain.brave.com");
+
+  auto make_request = [&profile](const std::string& url) {
+    auto request_info = std::make_shared<brave::BraveRequestInfo>(GURL(url));
+    request_info->resource_type = blink::mojom::ResourceType::kScript;
+    request_info->initiator_url = GURL("https://brave.com");
+    request_info->browser_context = &profile;
+    return request_info;
+  };
+
+  auto request_info = make_request("https://cloaked.brave.com/script.js");
+  EXPECT_TRUE(CheckRequest(request_info));
+  EXPECT_EQ(request_info->blocked_by, brave::kAdBlocked);
+  EXPECT_EQ(1ULL, host_resolver_->num_resolve());
+
+  // The canonical name is taken from the cache the second time.
+  request_info = make_request("https://cloaked.brave.com/other.js");
+  EXPECT_TRUE(CheckRequest(request_info));
+  EXPECT_EQ(request_info->blocked_by, brave::kAdBlocked);
+  EXPECT_EQ(1ULL, host_resolver_->num_resolve());
+
+  // So is the absence of a CNAME record.
+  request_info = make_request("https://plain.brave.com/script.js");
+  EXPECT_TRUE(CheckRequest(request_info));
+  EXPECT_EQ(request_info->blocked_by, brave::kNotBlocked);
+  EXPECT_EQ(2ULL, host_resolver_->num_resolve());
+
+  request_info = make_request("https://plain.brave.com/script.js");
+  EXPECT_TRUE(CheckRequest(request_info));
+  EXPECT_EQ(request_info->blocked_by, brave::kNotBlocked);
+  EXPECT_EQ(2ULL, host_resolver_->num_resolve());
+
+  brave::AdBlockCnameCache::Stats stats =
+      brave::GetAdblockCnameCacheForTesting(&profile)->stats();
+  EXPECT_EQ(2u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+
+  SystemNetworkContextManager::set_stub_resolver_config_reader_for_testing(
+      nullptr);
+}
+
+TEST_F(BraveAdBlockTPNetworkDelegateHelperTest,
+       CnameUncloakingCacheIsPerProfile) {
+  ScopedTestingLocalState local_state(TestingBrowserProcess::GetGlobal());
+  StubResolverConfigReader stub_resolver_config_reader(local_state.Get());
+  SystemNetworkContextManager::set_stub_resolver_config_reader_for_testing(
+      &stub_resolver_config_reader);
+  TestingProfile profile;
+  TestingProfile other_profile;
+
+  ResetAdblockInstance(g_brave_browser_process->ad_block_service(),
+                       "||tracker.com^", "");
+  host_resolver_->rules()->AddIPLiteralRule("cloaked.brave.com", "1.2.3.4",
+                                            "tracker.com");
+
+  auto make_request = [](content::BrowserContext* browser_context) {
+    auto request_info = std::make_shared<brave::BraveRequestInfo>(
+        GURL("https://cloaked.brave.com/script.js"));
+    request_info->resource_type = blink::mojom::ResourceType::kScript;
+    request_info->initiator_url = GURL("https://brave.com");
+    request_info->browser_context = browser_context;
+    return request_info;
+  };
+
+  auto request_info = make_request(&profile);
+  EXPECT_TRUE(CheckRequest(request_info));
+  EXPECT_EQ(request_info->blocked_by, brave::kAdBlocked);
+  EXPECT_EQ(1ULL, host_resolver_->num_resolve());
+
+  // The other profile does not see the first profile's entry.
+  request_info = make_request(&other_profile);
+  EXPECT_TRUE(CheckRequest(request_info));
+  EXPECT_EQ(request_info->blocked_by, brave::kAdBlocked);
+  EXPECT_EQ(2ULL, host_resolver_->num_resolve());
+
+  brave::AdBlockCnameCache::Stats stats =
+      brave::GetAdblockCnameCacheForTesting(&other_profile)->stats();
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+
+  SystemNetworkContextManager::set_stub_resolver_config_reader_for_testing(
+      nullptr);
+}
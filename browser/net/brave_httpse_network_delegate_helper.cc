@@ -11,6 +11,7 @@
 
 #include "base/task/post_task.h"
 #include "base/threading/scoped_blocking_call.h"
+#include "base/trace_event/trace_event.h"
 #include "brave/browser/brave_browser_process.h"
 #include "brave/browser/brave_shields/brave_shields_web_contents_observer.h"
 #include "brave/components/brave_shields/browser/https_everywhere_service.h"
@@ -23,7 +24,11 @@ using content::BrowserThread;
 
 namespace brave {
 
-void OnBeforeURLRequest_HttpseFileWork(std::shared_ptr<BraveRequestInfo> ctx) {
+void OnBeforeURLRequest_HttpseFileWork(std::shared_ptr<BraveRequestInfo> ctx,
+                                       base::TimeTicks posted_time) {
+  RecordTaskQueueTime("Brave.OnBeforeURLRequest_Httpse.TaskQueueTime",
+                      posted_time);
+  TRACE_EVENT0("net", "OnBeforeURLRequest_HttpseFileWork");
   base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
                                                 base::BlockingType::WILL_BLOCK);
   DCHECK_NE(ctx->request_identifier, 0U);
@@ -79,7 +84,9 @@ int OnBeforeURLRequest_HttpsePreFileWork(
       g_brave_browser_process->https_everywhere_service()
           ->GetTaskRunner()
           ->PostTaskAndReply(
-              FROM_HERE, base::BindOnce(OnBeforeURLRequest_HttpseFileWork, ctx),
+              FROM_HERE,
+              base::BindOnce(OnBeforeURLRequest_HttpseFileWork, ctx,
+                             base::TimeTicks::Now()),
               base::BindOnce(
                   base::IgnoreResult(&OnBeforeURLRequest_HttpsePostFileWork),
                   next_callback, ctx));
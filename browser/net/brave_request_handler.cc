@@ -9,8 +9,11 @@
 #include <utility>
 
 #include "base/feature_list.h"
+#include "base/metrics/histogram_functions.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/strings/strcat.h"
 #include "base/task/post_task.h"
+#include "base/trace_event/trace_event.h"
 #include "brave/browser/net/brave_ad_block_csp_network_delegate_helper.h"
 #include "brave/browser/net/brave_ad_block_tp_network_delegate_helper.h"
 #include "brave/browser/net/brave_common_static_redirect_network_delegate_helper.h"
@@ -67,6 +70,14 @@ static bool IsInternalScheme(std::shared_ptr<brave::BraveRequestInfo> ctx) {
          ctx->request_url.SchemeIs(content::kChromeUIScheme);
 }
 
+static void RunCompletionCallback(net::CompletionOnceCallback callback,
+                                  int rv,
+                                  base::TimeTicks posted_time) {
+  brave::RecordTaskQueueTime("Brave.BraveRequestHandler.CompletionQueueTime",
+                             posted_time);
+  std::move(callback).Run(rv);
+}
+
 BraveRequestHandler::BraveRequestHandler() {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   SetupCallbacks();
@@ -76,73 +87,109 @@ BraveRequestHandler::BraveRequestHandler() {
 
 BraveRequestHandler::~BraveRequestHandler() = default;
 
-void BraveRequestHandler::SetupCallbacks() {
-  brave::OnBeforeURLRequestCallback callback =
-      base::BindRepeating(brave::OnBeforeURLRequest_SiteHacksWork);
-  before_url_request_callbacks_.push_back(callback);
+void BraveRequestHandler::AddBeforeURLRequestHelper(
+    const char* name,
+    brave::OnBeforeURLRequestCallback callback,
+    bool can_redirect) {
+  before_url_request_helpers_.push_back(
+      {name, std::move(callback), can_redirect});
+}
 
-  callback = base::BindRepeating(brave::OnBeforeURLRequest_AdBlockTPPreWork);
-  before_url_request_callbacks_.push_back(callback);
+void BraveRequestHandler::AddBeforeStartTransactionHelper(
+    const char* name,
+    brave::OnBeforeStartTransactionCallback callback) {
+  before_start_transaction_helpers_.push_back({name, std::move(callback)});
+}
 
-  callback = base::BindRepeating(brave::OnBeforeURLRequest_HttpsePreFileWork);
-  before_url_request_callbacks_.push_back(callback);
+void BraveRequestHandler::AddHeadersReceivedHelper(
+    const char* name,
+    brave::OnHeadersReceivedCallback callback) {
+  headers_received_helpers_.push_back({name, std::move(callback)});
+}
 
-  callback =
-      base::BindRepeating(brave::OnBeforeURLRequest_CommonStaticRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+void BraveRequestHandler::SetupCallbacks() {
+  AddBeforeURLRequestHelper(
+      "OnBeforeURLRequest_SiteHacks",
+      base::BindRepeating(brave::OnBeforeURLRequest_SiteHacksWork),
+      /*can_redirect=*/true);
+
+  // Ad blocking only ever cancels requests, and it waits for the adblock task
+  // runner and possibly a DNS lookup, so let the helpers below run meanwhile.
+  AddBeforeURLRequestHelper(
+      "OnBeforeURLRequest_AdBlockTP",
+      base::BindRepeating(brave::OnBeforeURLRequest_AdBlockTPPreWork),
+      /*can_redirect=*/false);
+
+  AddBeforeURLRequestHelper(
+      "OnBeforeURLRequest_Httpse",
+      base::BindRepeating(brave::OnBeforeURLRequest_HttpsePreFileWork),
+      /*can_redirect=*/true);
+
+  AddBeforeURLRequestHelper(
+      "OnBeforeURLRequest_CommonStaticRedirect",
+      base::BindRepeating(brave::OnBeforeURLRequest_CommonStaticRedirectWork),
+      /*can_redirect=*/true);
 
 #if BUILDFLAG(DECENTRALIZED_DNS_ENABLED) && BUILDFLAG(BRAVE_WALLET_ENABLED)
-  callback = base::BindRepeating(
-      decentralized_dns::OnBeforeURLRequest_DecentralizedDnsPreRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestHelper(
+      "OnBeforeURLRequest_DecentralizedDns",
+      base::BindRepeating(
+          decentralized_dns::OnBeforeURLRequest_DecentralizedDnsPreRedirectWork),
+      /*can_redirect=*/true);
 #endif
 
 #if BUILDFLAG(BRAVE_REWARDS_ENABLED)
-  callback = base::BindRepeating(brave_rewards::OnBeforeURLRequest);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestHelper(
+      "OnBeforeURLRequest_Rewards",
+      base::BindRepeating(brave_rewards::OnBeforeURLRequest),
+      /*can_redirect=*/false);
 #endif
 
 #if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
-  callback =
-      base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestHelper(
+      "OnBeforeURLRequest_TranslateRedirect",
+      base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork),
+      /*can_redirect=*/true);
 #endif
 
 #if BUILDFLAG(IPFS_ENABLED)
   if (base::FeatureList::IsEnabled(ipfs::features::kIpfsFeature)) {
-    callback = base::BindRepeating(ipfs::OnBeforeURLRequest_IPFSRedirectWork);
-    before_url_request_callbacks_.push_back(callback);
-    brave::OnHeadersReceivedCallback ipfs_headers_received_callback =
-        base::BindRepeating(ipfs::OnHeadersReceived_IPFSRedirectWork);
-    headers_received_callbacks_.push_back(ipfs_headers_received_callback);
+    AddBeforeURLRequestHelper(
+        "OnBeforeURLRequest_IPFSRedirect",
+        base::BindRepeating(ipfs::OnBeforeURLRequest_IPFSRedirectWork),
+        /*can_redirect=*/true);
+    AddHeadersReceivedHelper(
+        "OnHeadersReceived_IPFSRedirect",
+        base::BindRepeating(ipfs::OnHeadersReceived_IPFSRedirectWork));
   }
 #endif
 
-  brave::OnBeforeStartTransactionCallback start_transaction_callback =
-      base::BindRepeating(brave::OnBeforeStartTransaction_SiteHacksWork);
-  before_start_transaction_callbacks_.push_back(start_transaction_callback);
+  AddBeforeStartTransactionHelper(
+      "OnBeforeStartTransaction_SiteHacks",
+      base::BindRepeating(brave::OnBeforeStartTransaction_SiteHacksWork));
 
-  start_transaction_callback = base::BindRepeating(
-      brave::OnBeforeStartTransaction_GlobalPrivacyControlWork);
-  before_start_transaction_callbacks_.push_back(start_transaction_callback);
+  AddBeforeStartTransactionHelper(
+      "OnBeforeStartTransaction_GlobalPrivacyControl",
+      base::BindRepeating(
+          brave::OnBeforeStartTransaction_GlobalPrivacyControlWork));
 
 #if BUILDFLAG(ENABLE_BRAVE_REFERRALS)
-  start_transaction_callback =
-      base::BindRepeating(brave::OnBeforeStartTransaction_ReferralsWork);
-  before_start_transaction_callbacks_.push_back(start_transaction_callback);
+  AddBeforeStartTransactionHelper(
+      "OnBeforeStartTransaction_Referrals",
+      base::BindRepeating(brave::OnBeforeStartTransaction_ReferralsWork));
 #endif
 
 #if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
-  brave::OnHeadersReceivedCallback headers_received_callback =
-      base::BindRepeating(webtorrent::OnHeadersReceived_TorrentRedirectWork);
-  headers_received_callbacks_.push_back(headers_received_callback);
+  AddHeadersReceivedHelper(
+      "OnHeadersReceived_TorrentRedirect",
+      base::BindRepeating(webtorrent::OnHeadersReceived_TorrentRedirectWork));
 #endif
 
   if (base::FeatureList::IsEnabled(
           ::brave_shields::features::kBraveAdblockCspRules)) {
-    brave::OnHeadersReceivedCallback headers_received_callback2 =
-        base::BindRepeating(brave::OnHeadersReceived_AdBlockCspWork);
-    headers_received_callbacks_.push_back(headers_received_callback2);
+    AddHeadersReceivedHelper(
+        "OnHeadersReceived_AdBlockCsp",
+        base::BindRepeating(brave::OnHeadersReceived_AdBlockCspWork));
   }
 }
 
@@ -178,7 +225,7 @@ int BraveRequestHandler::OnBeforeURLRequest(
     std::shared_ptr<brave::BraveRequestInfo> ctx,
     net::CompletionOnceCallback callback,
     GURL* new_url) {
-  if (before_url_request_callbacks_.empty() || IsInternalScheme(ctx)) {
+  if (before_url_request_helpers_.empty() || IsInternalScheme(ctx)) {
     return net::OK;
   }
   SCOPED_UMA_HISTOGRAM_TIMER("Brave.OnBeforeURLRequest_Handler");
@@ -193,7 +240,7 @@ int BraveRequestHandler::OnBeforeStartTransaction(
     std::shared_ptr<brave::BraveRequestInfo> ctx,
     net::CompletionOnceCallback callback,
     net::HttpRequestHeaders* headers) {
-  if (before_start_transaction_callbacks_.empty() || IsInternalScheme(ctx)) {
+  if (before_start_transaction_helpers_.empty() || IsInternalScheme(ctx)) {
     return net::OK;
   }
   ctx->event_type = brave::kOnBeforeStartTransaction;
@@ -216,7 +263,7 @@ int BraveRequestHandler::OnHeadersReceived(
         original_response_headers, override_response_headers);
   }
 
-  if (headers_received_callbacks_.empty() &&
+  if (headers_received_helpers_.empty() &&
       !ctx->request_url.SchemeIs(content::kChromeUIScheme)) {
     // Extension scheme not excluded since brave_webtorrent needs it.
     return net::OK;
@@ -247,7 +294,80 @@ void BraveRequestHandler::RunCallbackForRequestIdentifier(
   // We intentionally do the async call to maintain the proper flow
   // of URLLoader callbacks.
   base::PostTask(FROM_HERE, {content::BrowserThread::UI},
-                 base::BindOnce(std::move(it->second), rv));
+                 base::BindOnce(&RunCompletionCallback, std::move(it->second),
+                                rv, base::TimeTicks::Now()));
+}
+
+const char* BraveRequestHandler::GetHelperName(
+    brave::BraveNetworkDelegateEventType event_type,
+    size_t index) const {
+  switch (event_type) {
+    case brave::kOnBeforeRequest:
+      return before_url_request_helpers_[index].name;
+    case brave::kOnBeforeStartTransaction:
+      return before_start_transaction_helpers_[index].name;
+    case brave::kOnHeadersReceived:
+      return headers_received_helpers_[index].name;
+    default:
+      NOTREACHED();
+      return "";
+  }
+}
+
+base::TimeTicks BraveRequestHandler::OnHelperStarted(
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    size_t index) {
+  // Helpers of the same request may overlap, so each gets its own trace id.
+  TRACE_EVENT_NESTABLE_ASYNC_BEGIN1(
+      "net", GetHelperName(ctx->event_type, index),
+      TRACE_ID_WITH_SCOPE(GetHelperName(ctx->event_type, index),
+                          TRACE_ID_LOCAL(ctx.get())),
+      "request_identifier", ctx->request_identifier);
+  return base::TimeTicks::Now();
+}
+
+void BraveRequestHandler::OnHelperFinished(
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    size_t index,
+    base::TimeTicks start_time) {
+  const char* name = GetHelperName(ctx->event_type, index);
+  TRACE_EVENT_NESTABLE_ASYNC_END0(
+      "net", name, TRACE_ID_WITH_SCOPE(name, TRACE_ID_LOCAL(ctx.get())));
+  base::UmaHistogramTimes(base::StrCat({"Brave.", name}),
+                          base::TimeTicks::Now() - start_time);
+}
+
+void BraveRequestHandler::OnBeforeURLRequestHelperDone(
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    size_t index,
+    base::TimeTicks start_time) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  OnHelperFinished(ctx, index, start_time);
+
+  if (before_url_request_helpers_[index].can_redirect) {
+    RunNextCallback(ctx);
+    return;
+  }
+
+  DCHECK_GT(ctx->pending_url_request_helpers, 0u);
+  ctx->pending_url_request_helpers--;
+  // The helpers started after this one may still be running, or one of them
+  // may already have failed the request.
+  if (ctx->pending_url_request_helpers ||
+      !ctx->waiting_for_url_request_helpers) {
+    return;
+  }
+  ctx->waiting_for_url_request_helpers = false;
+  RunNextCallback(ctx);
+}
+
+void BraveRequestHandler::OnHelperDone(
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    size_t index,
+    base::TimeTicks start_time) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  OnHelperFinished(ctx, index, start_time);
+  RunNextCallback(ctx);
 }
 
 // TODO(iefremov): Merge all callback containers into one and run only one loop
@@ -264,50 +384,63 @@ void BraveRequestHandler::RunNextCallback(
   int rv = net::OK;
 
   if (ctx->event_type == brave::kOnBeforeRequest) {
-    while (before_url_request_callbacks_.size() !=
-           ctx->next_url_request_index) {
-      brave::OnBeforeURLRequestCallback callback =
-          before_url_request_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback =
-          base::BindRepeating(&BraveRequestHandler::RunNextCallback,
-                              weak_factory_.GetWeakPtr(), ctx);
-      rv = callback.Run(next_callback, ctx);
+    while (before_url_request_helpers_.size() != ctx->next_url_request_index) {
+      const size_t index = ctx->next_url_request_index++;
+      const BeforeURLRequestHelper& helper = before_url_request_helpers_[index];
+      const base::TimeTicks start_time = OnHelperStarted(ctx, index);
+      brave::ResponseCallback next_callback = base::BindRepeating(
+          &BraveRequestHandler::OnBeforeURLRequestHelperDone,
+          weak_factory_.GetWeakPtr(), ctx, index, start_time);
+      rv = helper.callback.Run(next_callback, ctx);
       if (rv == net::ERR_IO_PENDING) {
-        return;
+        if (helper.can_redirect) {
+          return;
+        }
+        ctx->pending_url_request_helpers++;
+        rv = net::OK;
+        continue;
       }
+      OnHelperFinished(ctx, index, start_time);
       if (rv != net::OK) {
         break;
       }
     }
+    if (rv == net::OK && ctx->pending_url_request_helpers) {
+      ctx->waiting_for_url_request_helpers = true;
+      return;
+    }
   } else if (ctx->event_type == brave::kOnBeforeStartTransaction) {
-    while (before_start_transaction_callbacks_.size() !=
+    while (before_start_transaction_helpers_.size() !=
            ctx->next_url_request_index) {
-      brave::OnBeforeStartTransactionCallback callback =
-          before_start_transaction_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback =
-          base::BindRepeating(&BraveRequestHandler::RunNextCallback,
-                              weak_factory_.GetWeakPtr(), ctx);
-      rv = callback.Run(ctx->headers, next_callback, ctx);
+      const size_t index = ctx->next_url_request_index++;
+      const base::TimeTicks start_time = OnHelperStarted(ctx, index);
+      brave::ResponseCallback next_callback = base::BindRepeating(
+          &BraveRequestHandler::OnHelperDone, weak_factory_.GetWeakPtr(), ctx,
+          index, start_time);
+      rv = before_start_transaction_helpers_[index].callback.Run(
+          ctx->headers, next_callback, ctx);
       if (rv == net::ERR_IO_PENDING) {
         return;
       }
+      OnHelperFinished(ctx, index, start_time);
       if (rv != net::OK) {
         break;
       }
     }
   } else if (ctx->event_type == brave::kOnHeadersReceived) {
-    while (headers_received_callbacks_.size() != ctx->next_url_request_index) {
-      brave::OnHeadersReceivedCallback callback =
-          headers_received_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback =
-          base::BindRepeating(&BraveRequestHandler::RunNextCallback,
-                              weak_factory_.GetWeakPtr(), ctx);
-      rv = callback.Run(ctx->original_response_headers,
-                        ctx->override_response_headers,
-                        ctx->allowed_unsafe_redirect_url, next_callback, ctx);
+    while (headers_received_helpers_.size() != ctx->next_url_request_index) {
+      const size_t index = ctx->next_url_request_index++;
+      const base::TimeTicks start_time = OnHelperStarted(ctx, index);
+      brave::ResponseCallback next_callback = base::BindRepeating(
+          &BraveRequestHandler::OnHelperDone, weak_factory_.GetWeakPtr(), ctx,
+          index, start_time);
+      rv = headers_received_helpers_[index].callback.Run(
+          ctx->original_response_headers, ctx->override_response_headers,
+          ctx->allowed_unsafe_redirect_url, next_callback, ctx);
       if (rv == net::ERR_IO_PENDING) {
         return;
       }
+      OnHelperFinished(ctx, index, start_time);
       if (rv != net::OK) {
         break;
       }
@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 
+#include "base/time/time.h"
 #include "brave/browser/net/url_context.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/base/completion_once_callback.h"
@@ -44,6 +45,59 @@ class BraveRequestHandler {
   void RunCallbackForRequestIdentifier(uint64_t request_identifier, int rv);
 
  private:
+  friend class BraveRequestHandlerTest;
+
+  // An OnBeforeURLRequest helper along with what it may do to the request.
+  struct BeforeURLRequestHelper {
+    // Name of the helper, used for its trace event and its Brave.<name>
+    // latency histogram, so renaming a helper renames its histogram.
+    const char* name;
+    brave::OnBeforeURLRequestCallback callback;
+    // Helpers which may redirect the request have to finish before the next
+    // helper starts, since later helpers look at |new_url_spec|. Helpers which
+    // can only cancel the request must update it on the UI thread; the
+    // helpers after them start without waiting for them to finish.
+    bool can_redirect;
+  };
+
+  struct BeforeStartTransactionHelper {
+    const char* name;
+    brave::OnBeforeStartTransactionCallback callback;
+  };
+
+  struct HeadersReceivedHelper {
+    const char* name;
+    brave::OnHeadersReceivedCallback callback;
+  };
+
+  void AddBeforeURLRequestHelper(const char* name,
+                                 brave::OnBeforeURLRequestCallback callback,
+                                 bool can_redirect);
+  void AddBeforeStartTransactionHelper(
+      const char* name,
+      brave::OnBeforeStartTransactionCallback callback);
+  void AddHeadersReceivedHelper(const char* name,
+                                brave::OnHeadersReceivedCallback callback);
+
+  // Returns the name of the |index|th helper run for |event_type|.
+  const char* GetHelperName(brave::BraveNetworkDelegateEventType event_type,
+                            size_t index) const;
+  // Begin and end the trace event of a helper run, and record its latency
+  // from |start_time| on, including the time its tasks spent queued.
+  base::TimeTicks OnHelperStarted(std::shared_ptr<brave::BraveRequestInfo> ctx,
+                                  size_t index);
+  void OnHelperFinished(std::shared_ptr<brave::BraveRequestInfo> ctx,
+                        size_t index,
+                        base::TimeTicks start_time);
+
+  void OnBeforeURLRequestHelperDone(
+      std::shared_ptr<brave::BraveRequestInfo> ctx,
+      size_t index,
+      base::TimeTicks start_time);
+  void OnHelperDone(std::shared_ptr<brave::BraveRequestInfo> ctx,
+                    size_t index,
+                    base::TimeTicks start_time);
+
   void SetupCallbacks();
   void InitPrefChangeRegistrar();
   void OnReferralHeadersChanged();
@@ -52,10 +106,9 @@ class BraveRequestHandler {
 
   void RunNextCallback(std::shared_ptr<brave::BraveRequestInfo> ctx);
 
-  std::vector<brave::OnBeforeURLRequestCallback> before_url_request_callbacks_;
-  std::vector<brave::OnBeforeStartTransactionCallback>
-      before_start_transaction_callbacks_;
-  std::vector<brave::OnHeadersReceivedCallback> headers_received_callbacks_;
+  std::vector<BeforeURLRequestHelper> before_url_request_helpers_;
+  std::vector<BeforeStartTransactionHelper> before_start_transaction_helpers_;
+  std::vector<HeadersReceivedHelper> headers_received_helpers_;
 
   // TODO(iefremov): actually, we don't have to keep the list here, since
   // it is global for the whole browser and could live a singletonce in the
@@ -0,0 +1,234 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/brave_request_handler.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "brave/browser/net/url_context.h"
+#include "chrome/test/base/scoped_testing_local_state.h"
+#include "chrome/test/base/testing_browser_process.h"
+#include "content/public/test/browser_task_environment.h"
+#include "net/base/net_errors.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+class BraveRequestHandlerTest : public testing::Test {
+ public:
+  BraveRequestHandlerTest()
+      : local_state_(TestingBrowserProcess::GetGlobal()),
+        handler_(std::make_unique<BraveRequestHandler>()) {}
+
+ protected:
+  std::vector<std::string> GetBeforeURLRequestHelperNames() const {
+    std::vector<std::string> names;
+    for (const auto& helper : handler_->before_url_request_helpers_)
+      names.push_back(helper.name);
+    return names;
+  }
+
+  std::vector<std::string> GetBeforeStartTransactionHelperNames() const {
+    std::vector<std::string> names;
+    for (const auto& helper : handler_->before_start_transaction_helpers_)
+      names.push_back(helper.name);
+    return names;
+  }
+
+  void SetBeforeStartTransactionHelper(
+      const char* name,
+      brave::OnBeforeStartTransactionCallback callback) {
+    handler_->before_start_transaction_helpers_.clear();
+    handler_->AddBeforeStartTransactionHelper(name, std::move(callback));
+  }
+
+  // Replaces the OnBeforeURLRequest helpers with ones which stay pending
+  // until the test finishes them.
+  void SetPendingHelpers(const std::vector<std::string>& names,
+                         const std::string& redirecting_helper) {
+    // The handler keeps pointers to the names.
+    helper_names_ = names;
+    handler_->before_url_request_helpers_.clear();
+    for (const auto& name : helper_names_) {
+      handler_->AddBeforeURLRequestHelper(
+          name.c_str(),
+          base::BindRepeating(&BraveRequestHandlerTest::RunPendingHelper,
+                              base::Unretained(this), name),
+          /*can_redirect=*/name == redirecting_helper);
+    }
+  }
+
+  int RunPendingHelper(const std::string& name,
+                       const brave::ResponseCallback& next_callback,
+                       std::shared_ptr<brave::BraveRequestInfo> ctx) {
+    started_helpers_.push_back(name);
+    pending_helpers_[name] = next_callback;
+    return net::ERR_IO_PENDING;
+  }
+
+  void FinishHelper(const std::string& name) {
+    ASSERT_TRUE(pending_helpers_.count(name));
+    brave::ResponseCallback next_callback = pending_helpers_[name];
+    pending_helpers_.erase(name);
+    next_callback.Run();
+    task_environment_.RunUntilIdle();
+  }
+
+  std::shared_ptr<brave::BraveRequestInfo> StartRequest(
+      uint64_t request_identifier) {
+    auto ctx = std::make_shared<brave::BraveRequestInfo>(
+        GURL("https://example.com/script.js"));
+    ctx->request_identifier = request_identifier;
+    EXPECT_EQ(net::ERR_IO_PENDING,
+              handler_->OnBeforeURLRequest(
+                  ctx,
+                  base::BindOnce(&BraveRequestHandlerTest::OnRequestDone,
+                                 base::Unretained(this)),
+                  &new_url_));
+    task_environment_.RunUntilIdle();
+    return ctx;
+  }
+
+  void OnRequestDone(int rv) { results_.push_back(rv); }
+
+  content::BrowserTaskEnvironment task_environment_;
+  ScopedTestingLocalState local_state_;
+  std::unique_ptr<BraveRequestHandler> handler_;
+
+  std::vector<std::string> helper_names_;
+  std::vector<std::string> started_helpers_;
+  std::map<std::string, brave::ResponseCallback> pending_helpers_;
+  std::vector<int> results_;
+  GURL new_url_;
+};
+
+TEST_F(BraveRequestHandlerTest, BeforeURLRequestHelperNames) {
+  // The names are part of the helpers' histogram names.
+  const std::vector<std::string> names = GetBeforeURLRequestHelperNames();
+  for (const char* name :
+       {"OnBeforeURLRequest_SiteHacks", "OnBeforeURLRequest_AdBlockTP",
+        "OnBeforeURLRequest_Httpse",
+        "OnBeforeURLRequest_CommonStaticRedirect"}) {
+    EXPECT_NE(names.end(), std::find(names.begin(), names.end(), name));
+  }
+}
+
+TEST_F(BraveRequestHandlerTest, BeforeStartTransactionHelperNames) {
+  const std::vector<std::string> names =
+      GetBeforeStartTransactionHelperNames();
+  for (const char* name : {"OnBeforeStartTransaction_SiteHacks",
+                           "OnBeforeStartTransaction_GlobalPrivacyControl"}) {
+    EXPECT_NE(names.end(), std::find(names.begin(), names.end(), name));
+  }
+}
+
+TEST_F(BraveRequestHandlerTest, BeforeStartTransactionHelperHistogram) {
+  base::HistogramTester histogram_tester;
+  SetBeforeStartTransactionHelper(
+      "OnBeforeStartTransaction_Test",
+      base::BindRepeating([](net::HttpRequestHeaders* headers,
+                             const brave::ResponseCallback& next_callback,
+                             std::shared_ptr<brave::BraveRequestInfo> ctx) {
+        return net::OK;
+      }));
+
+  auto ctx = std::make_shared<brave::BraveRequestInfo>(
+      GURL("https://example.com/script.js"));
+  ctx->request_identifier = 1;
+  net::HttpRequestHeaders headers;
+  EXPECT_EQ(net::ERR_IO_PENDING,
+            handler_->OnBeforeStartTransaction(
+                ctx,
+                base::BindOnce(&BraveRequestHandlerTest::OnRequestDone,
+                               base::Unretained(this)),
+                &headers));
+  task_environment_.RunUntilIdle();
+
+  EXPECT_EQ(std::vector<int>({net::OK}), results_);
+  histogram_tester.ExpectTotalCount("Brave.OnBeforeStartTransaction_Test", 1);
+}
+
+TEST_F(BraveRequestHandlerTest, BeforeURLRequestHelperHistogram) {
+  base::HistogramTester histogram_tester;
+  SetPendingHelpers({"OnBeforeURLRequest_Test"}, "");
+
+  StartRequest(1);
+  FinishHelper("OnBeforeURLRequest_Test");
+
+  EXPECT_EQ(std::vector<int>({net::OK}), results_);
+  histogram_tester.ExpectTotalCount("Brave.OnBeforeURLRequest_Test", 1);
+}
+
+TEST_F(BraveRequestHandlerTest, EachHelperCompletesOnce) {
+  SetPendingHelpers({"First", "Second", "Redirect"}, "Redirect");
+
+  StartRequest(1);
+  // Only the redirecting helper holds back the helpers after it.
+  EXPECT_EQ(3u, started_helpers_.size());
+
+  FinishHelper("Redirect");
+  FinishHelper("Second");
+  EXPECT_TRUE(results_.empty());
+
+  FinishHelper("First");
+  EXPECT_EQ(std::vector<int>({net::OK}), results_);
+  EXPECT_EQ(3u, started_helpers_.size());
+}
+
+TEST_F(BraveRequestHandlerTest, BlockWinsInAnyCompletionOrder) {
+  std::vector<std::string> names = {"AdBlock", "Other", "Redirect"};
+  SetPendingHelpers(names, "Redirect");
+  std::sort(names.begin(), names.end());
+
+  uint64_t request_identifier = 1;
+  do {
+    results_.clear();
+    auto ctx = StartRequest(request_identifier++);
+    for (const auto& name : names) {
+      if (name == "AdBlock")
+        ctx->blocked_by = brave::kAdBlocked;
+      FinishHelper(name);
+    }
+    EXPECT_EQ(std::vector<int>({net::ERR_BLOCKED_BY_CLIENT}), results_);
+  } while (std::next_permutation(names.begin(), names.end()));
+}
+
+TEST_F(BraveRequestHandlerTest, RedirectWinsInAnyCompletionOrder) {
+  std::vector<std::string> names = {"First", "Second", "Redirect"};
+  SetPendingHelpers(names, "Redirect");
+  std::sort(names.begin(), names.end());
+
+  uint64_t request_identifier = 1;
+  do {
+    results_.clear();
+    new_url_ = GURL();
+    auto ctx = StartRequest(request_identifier++);
+    for (const auto& name : names) {
+      if (name == "Redirect")
+        ctx->new_url_spec = "https://example.org/";
+      FinishHelper(name);
+    }
+    EXPECT_EQ(std::vector<int>({net::OK}), results_);
+    EXPECT_EQ(GURL("https://example.org/"), new_url_);
+  } while (std::next_permutation(names.begin(), names.end()));
+}
+
+TEST_F(BraveRequestHandlerTest, CancelledRequestDoesNotRunCallback) {
+  SetPendingHelpers({"First", "Second"}, "");
+
+  auto ctx = StartRequest(1);
+  FinishHelper("First");
+
+  handler_->OnURLRequestDestroyed(ctx);
+  FinishHelper("Second");
+
+  EXPECT_TRUE(results_.empty());
+}
@@ -8,6 +8,7 @@
 #include <memory>
 #include <string>
 
+#include "base/metrics/histogram_functions.h"
 #include "brave/browser/brave_shields/brave_shields_web_contents_observer.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_webtorrent/browser/buildflags/buildflags.h"
@@ -163,4 +164,9 @@ std::shared_ptr<brave::BraveRequestInfo> BraveRequestInfo::MakeCTX(
   return ctx;
 }
 
+void RecordTaskQueueTime(const std::string& histogram_name,
+                         base::TimeTicks posted_time) {
+  base::UmaHistogramTimes(histogram_name, base::TimeTicks::Now() - posted_time);
+}
+
 }  // namespace brave
@@ -10,6 +10,7 @@
 #include <set>
 #include <string>
 
+#include "base/time/time.h"
 #include "net/base/network_isolation_key.h"
 #include "net/http/http_request_headers.h"
 #include "net/http/http_response_headers.h"
@@ -127,6 +128,12 @@ struct BraveRequestInfo {
   friend class ::BraveRequestHandler;
 
   GURL* new_url = nullptr;
+  // Number of OnBeforeURLRequest helpers which have not finished yet while
+  // the helpers after them already run.
+  size_t pending_url_request_helpers = 0;
+  // Whether all the OnBeforeURLRequest helpers have been started and the
+  // handler only waits for |pending_url_request_helpers| to finish.
+  bool waiting_for_url_request_helpers = false;
 
   DISALLOW_COPY_AND_ASSIGN(BraveRequestInfo);
 };
@@ -146,6 +153,12 @@ using OnHeadersReceivedCallback = base::RepeatingCallback<int(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx)>;
 
+// Records the time between |posted_time| and now as |histogram_name|. Helpers
+// call this first thing in tasks they post to other task runners, so that time
+// spent waiting in a queue can be told apart from the work itself.
+void RecordTaskQueueTime(const std::string& histogram_name,
+                         base::TimeTicks posted_time);
+
 }  // namespace brave
 
 #endif  // BRAVE_BROWSER_NET_URL_CONTEXT_H_
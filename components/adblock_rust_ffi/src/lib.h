@@ -18,6 +18,19 @@ typedef struct C_Engine C_Engine;
  */
 typedef void (*C_DomainResolverCallback)(const char*, uint32_t*, uint32_t*);
 
+/**
+ * An external callback that receives one string of a cosmetic filtering result, given as a
+ * pointer and a length since it is not nul-terminated, along with the caller-provided context.
+ */
+typedef void (*C_CosmeticStringCallback)(void*, const char*, size_t);
+
+/**
+ * An external callback that receives one style of a cosmetic filtering style selector, given as
+ * the selector and the style, neither of which is nul-terminated, along with the caller-provided
+ * context. A selector without any style is passed once, with a null style.
+ */
+typedef void (*C_CosmeticStyleCallback)(void*, const char*, size_t, const char*, size_t);
+
 /**
  * Passes a callback to the adblock library, allowing it to be used for domain resolution.
  *
@@ -122,4 +135,33 @@ char *engine_hidden_class_id_selectors(struct C_Engine *engine,
                                        const char *const *exceptions,
                                        size_t exceptions_size);
 
+/**
+ * Passes the set of cosmetic filtering resources specific to the given url to the provided
+ * callbacks one value at a time, instead of serializing them to JSON.
+ */
+void engine_url_cosmetic_resources_visit(struct C_Engine *engine,
+                                         const char *url,
+                                         void *context,
+                                         C_CosmeticStringCallback hide_selector_callback,
+                                         C_CosmeticStyleCallback style_selector_callback,
+                                         C_CosmeticStringCallback exception_callback,
+                                         C_CosmeticStringCallback injected_script_callback,
+                                         bool *generichide);
+
+/**
+ * Passes each generic cosmetic selector that begins with any of the provided class and id
+ * selectors to the provided callback, instead of serializing them to JSON.
+ *
+ * The leading '.' or '#' character should not be provided
+ */
+void engine_hidden_class_id_selectors_visit(struct C_Engine *engine,
+                                            const char *const *classes,
+                                            size_t classes_size,
+                                            const char *const *ids,
+                                            size_t ids_size,
+                                            const char *const *exceptions,
+                                            size_t exceptions_size,
+                                            void *context,
+                                            C_CosmeticStringCallback selector_callback);
+
 #endif /* ADBLOCK_RUST_FFI_H */
@@ -5,6 +5,7 @@ use libc::size_t;
 use std::ffi::CStr;
 use std::ffi::CString;
 use std::os::raw::c_char;
+use std::os::raw::c_void;
 use std::string::String;
 
 /// An external callback that receives a hostname and two out-parameters for start and end
@@ -12,6 +13,16 @@ use std::string::String;
 /// of the domain part of the hostname.
 pub type DomainResolverCallback = unsafe extern "C" fn(*const c_char, *mut u32, *mut u32);
 
+/// An external callback that receives one string of a cosmetic filtering result, given as a
+/// pointer and a length since it is not nul-terminated, along with the caller-provided context.
+pub type CosmeticStringCallback = unsafe extern "C" fn(*mut c_void, *const c_char, size_t);
+
+/// An external callback that receives one style of a cosmetic filtering style selector, given as
+/// the selector and the style, neither of which is nul-terminated, along with the caller-provided
+/// context. A selector without any style is passed once, with a null style.
+pub type CosmeticStyleCallback =
+    unsafe extern "C" fn(*mut c_void, *const c_char, size_t, *const c_char, size_t);
+
 /// Passes a callback to the adblock library, allowing it to be used for domain resolution.
 ///
 /// This is required to be able to use any adblocking functionality.
@@ -272,3 +283,89 @@ pub unsafe extern "C" fn engine_hidden_class_id_selectors(
     let stylesheet = engine.hidden_class_id_selectors(&classes, &ids, &exceptions);
     CString::new(serde_json::to_string(&stylesheet).unwrap_or_else(|_| "".into())).expect("Error: CString::new()").into_raw()
 }
+
+/// Passes the set of cosmetic filtering resources specific to the given url to the provided
+/// callbacks one value at a time, instead of serializing them to JSON.
+#[no_mangle]
+pub unsafe extern "C" fn engine_url_cosmetic_resources_visit(
+    engine: *mut Engine,
+    url: *const c_char,
+    context: *mut c_void,
+    hide_selector_callback: CosmeticStringCallback,
+    style_selector_callback: CosmeticStyleCallback,
+    exception_callback: CosmeticStringCallback,
+    injected_script_callback: CosmeticStringCallback,
+    generichide: *mut bool,
+) {
+    let url = CStr::from_ptr(url).to_str().unwrap();
+    assert!(!engine.is_null());
+    let engine = Box::leak(Box::from_raw(engine));
+    let resources = engine.url_cosmetic_resources(url);
+    for selector in resources.hide_selectors.iter() {
+        hide_selector_callback(context, selector.as_ptr() as *const c_char, selector.len());
+    }
+    for (selector, styles) in resources.style_selectors.iter() {
+        if styles.is_empty() {
+            style_selector_callback(
+                context,
+                selector.as_ptr() as *const c_char,
+                selector.len(),
+                ptr::null(),
+                0,
+            );
+        }
+        for style in styles.iter() {
+            style_selector_callback(
+                context,
+                selector.as_ptr() as *const c_char,
+                selector.len(),
+                style.as_ptr() as *const c_char,
+                style.len(),
+            );
+        }
+    }
+    for exception in resources.exceptions.iter() {
+        exception_callback(context, exception.as_ptr() as *const c_char, exception.len());
+    }
+    injected_script_callback(
+        context,
+        resources.injected_script.as_ptr() as *const c_char,
+        resources.injected_script.len(),
+    );
+    *generichide = resources.generichide;
+}
+
+/// Passes each generic cosmetic selector that begins with any of the provided class and id
+/// selectors to the provided callback, instead of serializing them to JSON.
+///
+/// The leading '.' or '#' character should not be provided
+#[no_mangle]
+pub unsafe extern "C" fn engine_hidden_class_id_selectors_visit(
+    engine: *mut Engine,
+    classes: *const *const c_char,
+    classes_size: size_t,
+    ids: *const *const c_char,
+    ids_size: size_t,
+    exceptions: *const *const c_char,
+    exceptions_size: size_t,
+    context: *mut c_void,
+    selector_callback: CosmeticStringCallback,
+) {
+    let classes = std::slice::from_raw_parts(classes, classes_size);
+    let classes: Vec<String> = (0..classes_size)
+        .map(|index| CStr::from_ptr(classes[index]).to_str().unwrap().to_owned())
+        .collect();
+    let ids = std::slice::from_raw_parts(ids, ids_size);
+    let ids: Vec<String> = (0..ids_size)
+        .map(|index| CStr::from_ptr(ids[index]).to_str().unwrap().to_owned())
+        .collect();
+    let exceptions = std::slice::from_raw_parts(exceptions, exceptions_size);
+    let exceptions: std::collections::HashSet<String> = (0..exceptions_size)
+        .map(|index| CStr::from_ptr(exceptions[index]).to_str().unwrap().to_owned())
+        .collect();
+    assert!(!engine.is_null());
+    let engine = Box::leak(Box::from_raw(engine));
+    for selector in engine.hidden_class_id_selectors(&classes, &ids, &exceptions).iter() {
+        selector_callback(context, selector.as_ptr() as *const c_char, selector.len());
+    }
+}
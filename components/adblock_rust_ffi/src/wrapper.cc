@@ -12,6 +12,57 @@ extern "C" {
 
 namespace adblock {
 
+namespace {
+
+void OnHideSelector(void* context, const char* data, size_t size) {
+  static_cast<UrlCosmeticResources*>(context)->hide_selectors.emplace_back(
+      data, size);
+}
+
+void OnStyleSelector(void* context,
+                     const char* selector,
+                     size_t selector_size,
+                     const char* style,
+                     size_t style_size) {
+  std::vector<std::string>& styles =
+      static_cast<UrlCosmeticResources*>(context)
+          ->style_selectors[std::string(selector, selector_size)];
+  if (style)
+    styles.emplace_back(style, style_size);
+}
+
+void OnException(void* context, const char* data, size_t size) {
+  static_cast<UrlCosmeticResources*>(context)->exceptions.emplace_back(data,
+                                                                      size);
+}
+
+void OnInjectedScript(void* context, const char* data, size_t size) {
+  static_cast<UrlCosmeticResources*>(context)->injected_script.assign(data,
+                                                                      size);
+}
+
+void OnSelector(void* context, const char* data, size_t size) {
+  static_cast<std::vector<std::string>*>(context)->emplace_back(data, size);
+}
+
+std::vector<const char*> ToRawStrings(const std::vector<std::string>& strings) {
+  std::vector<const char*> raw;
+  raw.reserve(strings.size());
+  for (const auto& string : strings) {
+    raw.push_back(string.c_str());
+  }
+  return raw;
+}
+
+}  // namespace
+
+UrlCosmeticResources::UrlCosmeticResources() = default;
+UrlCosmeticResources::UrlCosmeticResources(UrlCosmeticResources&& other) =
+    default;
+UrlCosmeticResources& UrlCosmeticResources::operator=(
+    UrlCosmeticResources&& other) = default;
+UrlCosmeticResources::~UrlCosmeticResources() = default;
+
 bool SetDomainResolver(DomainResolverCallback resolver) {
   return set_domain_resolver(resolver);
 }
@@ -144,6 +195,30 @@ const std::string Engine::hiddenClassIdSelectors(
   return stylesheet;
 }
 
+UrlCosmeticResources Engine::getUrlCosmeticResources(const std::string& url) {
+  UrlCosmeticResources resources;
+  engine_url_cosmetic_resources_visit(raw, url.c_str(), &resources,
+                                      &OnHideSelector, &OnStyleSelector,
+                                      &OnException, &OnInjectedScript,
+                                      &resources.generichide);
+  return resources;
+}
+
+std::vector<std::string> Engine::getHiddenClassIdSelectors(
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& exceptions) {
+  const std::vector<const char*> classes_raw = ToRawStrings(classes);
+  const std::vector<const char*> ids_raw = ToRawStrings(ids);
+  const std::vector<const char*> exceptions_raw = ToRawStrings(exceptions);
+
+  std::vector<std::string> selectors;
+  engine_hidden_class_id_selectors_visit(
+      raw, classes_raw.data(), classes.size(), ids_raw.data(), ids.size(),
+      exceptions_raw.data(), exceptions.size(), &selectors, &OnSelector);
+  return selectors;
+}
+
 Engine::~Engine() {
   engine_destroy(raw);
 }
@@ -5,6 +5,7 @@
 
 #ifndef BRAVE_COMPONENTS_ADBLOCK_RUST_FFI_SRC_WRAPPER_H_
 #define BRAVE_COMPONENTS_ADBLOCK_RUST_FFI_SRC_WRAPPER_H_
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -64,6 +65,20 @@ class ADBLOCK_EXPORT FilterList {
   static std::vector<FilterList> regional_list;
 };
 
+// Cosmetic filtering resources specific to a url.
+struct ADBLOCK_EXPORT UrlCosmeticResources {
+  UrlCosmeticResources();
+  UrlCosmeticResources(UrlCosmeticResources&& other);
+  UrlCosmeticResources& operator=(UrlCosmeticResources&& other);
+  ~UrlCosmeticResources();
+
+  std::vector<std::string> hide_selectors;
+  std::map<std::string, std::vector<std::string>> style_selectors;
+  std::vector<std::string> exceptions;
+  std::string injected_script;
+  bool generichide = false;
+};
+
 class ADBLOCK_EXPORT Engine {
  public:
   Engine();
@@ -95,6 +110,12 @@ class ADBLOCK_EXPORT Engine {
       const std::vector<std::string>& classes,
       const std::vector<std::string>& ids,
       const std::vector<std::string>& exceptions);
+  // Same as above, but without going through JSON.
+  UrlCosmeticResources getUrlCosmeticResources(const std::string& url);
+  std::vector<std::string> getHiddenClassIdSelectors(
+      const std::vector<std::string>& classes,
+      const std::vector<std::string>& ids,
+      const std::vector<std::string>& exceptions);
   ~Engine();
 
  private:
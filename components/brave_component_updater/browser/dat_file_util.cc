@@ -34,6 +34,17 @@ void GetDATFileData(const base::FilePath& file_path,
   }
 }
 
+bool MapDATFile(const base::FilePath& file_path,
+                base::MemoryMappedFile* mapped_file) {
+  if (!mapped_file->Initialize(file_path) || 0 == mapped_file->length()) {
+    LOG(ERROR) << "MapDATFile: "
+               << "the dat file is not found or corrupted "
+               << file_path;
+    return false;
+  }
+  return true;
+}
+
 std::string GetDATFileAsString(const base::FilePath& file_path) {
   std::string contents;
   bool success = base::ReadFileToString(file_path, &contents);
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
 
 namespace brave_component_updater {
 
@@ -20,13 +21,34 @@ using DATFileDataBuffer = std::vector<unsigned char>;
 void GetDATFileData(const base::FilePath& file_path,
                     DATFileDataBuffer* buffer);
 std::string GetDATFileAsString(const base::FilePath& file_path);
+bool MapDATFile(const base::FilePath& file_path,
+                base::MemoryMappedFile* mapped_file);
 
 template<typename T>
 using LoadDATFileDataResult =
     std::pair<std::unique_ptr<T>, brave_component_updater::DATFileDataBuffer>;
 
+// Deserializes the DAT file straight from a read-only memory mapping, which is
+// released before returning, so the file contents are never copied to the
+// heap. Only use this for parsers that copy what they need out of the data.
 template<typename T>
-LoadDATFileDataResult<T> LoadDATFileData(
+std::unique_ptr<T> LoadDATFileData(const base::FilePath& dat_file_path) {
+  base::MemoryMappedFile mapped_file;
+  if (!MapDATFile(dat_file_path, &mapped_file))
+    return nullptr;
+
+  auto client = std::make_unique<T>();
+  if (!client->deserialize(reinterpret_cast<const char*>(mapped_file.data()),
+                           mapped_file.length()))
+    return nullptr;
+
+  return client;
+}
+
+// Reads the DAT file into a buffer that is handed back along with the
+// deserialized data, for parsers that keep referencing the buffer.
+template<typename T>
+LoadDATFileDataResult<T> LoadDATFileDataToBuffer(
     const base::FilePath& dat_file_path) {
   DATFileDataBuffer buffer;
   GetDATFileData(dat_file_path, &buffer);
@@ -69,7 +69,8 @@ void ExtensionWhitelistService::OnComponentReady(
       local_data_files_service()->GetTaskRunner().get(),
       FROM_HERE,
       base::BindOnce(
-          &brave_component_updater::LoadDATFileData<ExtensionWhitelistParser>,
+          &brave_component_updater::LoadDATFileDataToBuffer<
+              ExtensionWhitelistParser>,
           dat_file_path),
       base::BindOnce(&ExtensionWhitelistService::OnGetDATFileData,
                      weak_factory_.GetWeakPtr()));
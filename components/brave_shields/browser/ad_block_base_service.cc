@@ -6,16 +6,18 @@
 #include "brave/components/brave_shields/browser/ad_block_base_service.h"
 
 #include <algorithm>
+#include <atomic>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "base/barrier_closure.h"
 #include "base/bind.h"
 #include "base/files/file_path.h"
-#include "base/json/json_reader.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/task/post_task.h"
 #include "base/task/thread_pool.h"
 #include "brave/components/adblock_rust_ffi/src/wrapper.h"
@@ -32,6 +34,12 @@ using namespace net::registry_controlled_domains;  // NOLINT
 
 namespace {
 
+std::atomic<uint64_t> g_engine_generation(0);
+
+// Below this many engines a thread hop costs more than the matches it runs in
+// parallel.
+constexpr size_t kMinEnginesForConcurrentMatch = 3;
+
 std::string ResourceTypeToString(blink::mojom::ResourceType resource_type) {
   std::string filter_option = "";
   switch (resource_type) {
@@ -111,6 +119,24 @@ AdBlockBaseService::~AdBlockBaseService() {
   GetTaskRunner()->DeleteSoon(FROM_HERE, ad_block_client_.release());
 }
 
+AdBlockEngineRequest::AdBlockEngineRequest(
+    const GURL& url,
+    blink::mojom::ResourceType resource_type,
+    const std::string& tab_host)
+    : url(url.spec()),
+      host(url.host()),
+      tab_host(tab_host),
+      // Determine third-party here so the library doesn't need to figure it
+      // out. CreateFromNormalizedTuple is needed because SameDomainOrHost
+      // needs a URL or origin and not a string to a host name.
+      is_third_party(!SameDomainOrHost(
+          url,
+          url::Origin::CreateFromNormalizedTuple("https", tab_host.c_str(), 80),
+          INCLUDE_PRIVATE_REGISTRIES)),
+      resource_type(ResourceTypeToString(resource_type)) {}
+
+AdBlockEngineRequest::~AdBlockEngineRequest() = default;
+
 void AdBlockBaseService::ShouldStartRequest(
     const GURL& url,
     blink::mojom::ResourceType resource_type,
@@ -119,42 +145,129 @@ void AdBlockBaseService::ShouldStartRequest(
     bool* did_match_exception,
     bool* did_match_important,
     std::string* mock_data_url) {
+  MatchRequest(AdBlockEngineRequest(url, resource_type, tab_host),
+               did_match_rule, did_match_exception, did_match_important,
+               mock_data_url);
+}
+
+void AdBlockBaseService::MatchRequest(const AdBlockEngineRequest& request,
+                                      bool* did_match_rule,
+                                      bool* did_match_exception,
+                                      bool* did_match_important,
+                                      std::string* mock_data_url) {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  ad_block_client_->matches(
+      request.url, request.host, request.tab_host, request.is_third_party,
+      request.resource_type, did_match_rule, did_match_exception,
+      did_match_important, mock_data_url);
+}
 
-  // Determine third-party here so the library doesn't need to figure it out.
-  // CreateFromNormalizedTuple is needed because SameDomainOrHost needs
-  // a URL or origin and not a string to a host name.
-  bool is_third_party = !SameDomainOrHost(
-      url,
-      url::Origin::CreateFromNormalizedTuple("https", tab_host.c_str(), 80),
-      INCLUDE_PRIVATE_REGISTRIES);
+void AdBlockBaseService::MatchRequestOnEngine(
+    const AdBlockEngineRequest& request,
+    AdBlockMatchResult* result) {
   ad_block_client_->matches(
-      url.spec(), url.host(), tab_host, is_third_party,
-      ResourceTypeToString(resource_type), did_match_rule,
-      did_match_exception, did_match_important, mock_data_url);
-
-  // LOG(ERROR) << "AdBlockBaseService::ShouldStartRequest(), host: "
-  //  << tab_host
-  //  << ", resource type: " << resource_type
-  //  << ", url.spec(): " << url.spec();
+      request.url, request.host, request.tab_host, request.is_third_party,
+      request.resource_type, &result->did_match_rule,
+      &result->did_match_exception, &result->did_match_important,
+      &result->mock_data_url);
+}
+
+// static
+void AdBlockBaseService::MatchRequestOnWorker(
+    AdBlockBaseService* service,
+    const AdBlockEngineRequest* request,
+    AdBlockMatchResult* result,
+    base::OnceClosure done) {
+  service->MatchRequestOnEngine(*request, result);
+  std::move(done).Run();
+}
+
+// static
+void AdBlockBaseService::MatchRequestInOrder(
+    const std::vector<AdBlockBaseService*>& services,
+    const AdBlockEngineRequest& request,
+    bool* did_match_rule,
+    bool* did_match_exception,
+    bool* did_match_important,
+    std::string* mock_data_url) {
+  DCHECK(did_match_rule && did_match_exception && did_match_important);
+  if (services.empty())
+    return;
+  DCHECK(services[0]->GetTaskRunner()->RunsTasksInCurrentSequence());
+
+  // Each engine is only used by one thread at a time: the workers each get
+  // their own engine, and this sequence, which owns all of them, waits for
+  // the workers before touching the engines again.
+  std::vector<AdBlockMatchResult> concurrent_results;
+  if (services.size() >= kMinEnginesForConcurrentMatch &&
+      !*did_match_rule && !*did_match_exception) {
+    concurrent_results.resize(services.size());
+    base::WaitableEvent workers_done;
+    base::RepeatingClosure worker_done = base::BarrierClosure(
+        services.size() - 1,
+        base::BindOnce(&base::WaitableEvent::Signal,
+                       base::Unretained(&workers_done)));
+    for (size_t i = 1; i < services.size(); ++i) {
+      // This sequence blocks shutdown while it waits, so the workers must
+      // still run once shutdown has started.
+      base::ThreadPool::PostTask(
+          FROM_HERE,
+          {base::TaskPriority::USER_BLOCKING,
+           base::TaskShutdownBehavior::BLOCK_SHUTDOWN},
+          base::BindOnce(&AdBlockBaseService::MatchRequestOnWorker,
+                         base::Unretained(services[i]),
+                         base::Unretained(&request),
+                         base::Unretained(&concurrent_results[i]),
+                         worker_done));
+    }
+    services[0]->MatchRequestOnEngine(request, &concurrent_results[0]);
+    workers_done.Wait();
+  }
+
+  AdBlockMatchResult result;
+  result.did_match_rule = *did_match_rule;
+  result.did_match_exception = *did_match_exception;
+  result.did_match_important = *did_match_important;
+  for (size_t i = 0; i < services.size(); ++i) {
+    // A concurrent result was computed as if no engine before it matched,
+    // so it can only be used while that is still true.
+    if (!concurrent_results.empty() && !result.did_match_rule &&
+        !result.did_match_exception) {
+      const AdBlockMatchResult& engine_result = concurrent_results[i];
+      result.did_match_rule = engine_result.did_match_rule;
+      result.did_match_exception = engine_result.did_match_exception;
+      result.did_match_important |= engine_result.did_match_important;
+      if (!engine_result.mock_data_url.empty())
+        result.mock_data_url = engine_result.mock_data_url;
+    } else {
+      services[i]->MatchRequestOnEngine(request, &result);
+    }
+
+    if (result.did_match_important)
+      break;
+  }
+
+  *did_match_rule = result.did_match_rule;
+  *did_match_exception = result.did_match_exception;
+  *did_match_important = result.did_match_important;
+  if (mock_data_url && !result.mock_data_url.empty())
+    *mock_data_url = result.mock_data_url;
 }
 
 base::Optional<std::string> AdBlockBaseService::GetCspDirectives(
     const GURL& url,
     blink::mojom::ResourceType resource_type,
     const std::string& tab_host) {
-  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  return GetCspDirectivesForRequest(
+      AdBlockEngineRequest(url, resource_type, tab_host));
+}
 
-  // Determine third-party here so the library doesn't need to figure it out.
-  // CreateFromNormalizedTuple is needed because SameDomainOrHost needs
-  // a URL or origin and not a string to a host name.
-  bool is_third_party = !SameDomainOrHost(
-      url,
-      url::Origin::CreateFromNormalizedTuple("https", tab_host.c_str(), 80),
-      INCLUDE_PRIVATE_REGISTRIES);
+base::Optional<std::string> AdBlockBaseService::GetCspDirectivesForRequest(
+    const AdBlockEngineRequest& request) {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
   const std::string result = ad_block_client_->getCspDirectives(
-      url.spec(), url.host(), tab_host, is_third_party,
-      ResourceTypeToString(resource_type));
+      request.url, request.host, request.tab_host, request.is_third_party,
+      request.resource_type);
 
   if (result.empty()) {
     return base::nullopt;
@@ -182,6 +295,7 @@ void AdBlockBaseService::EnableTag(const std::string& tag, bool enabled) {
       tags_.erase(it);
     }
   }
+  IncrementEngineGeneration();
 }
 
 void AdBlockBaseService::AddResources(const std::string& resources) {
@@ -194,25 +308,35 @@ void AdBlockBaseService::AddResources(const std::string& resources) {
 
   ad_block_client_->addResources(resources);
   resources_ = resources;
+  IncrementEngineGeneration();
 }
 
 bool AdBlockBaseService::TagExists(const std::string& tag) {
   return std::find(tags_.begin(), tags_.end(), tag) != tags_.end();
 }
 
-base::Optional<base::Value> AdBlockBaseService::UrlCosmeticResources(
-        const std::string& url) {
+CosmeticResources AdBlockBaseService::UrlCosmeticResources(
+    const std::string& url) {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
-  return base::JSONReader::Read(ad_block_client_->urlCosmeticResources(url));
+  return CosmeticResources(ad_block_client_->getUrlCosmeticResources(url));
 }
 
-base::Optional<base::Value> AdBlockBaseService::HiddenClassIdSelectors(
-        const std::vector<std::string>& classes,
-        const std::vector<std::string>& ids,
-        const std::vector<std::string>& exceptions) {
+std::vector<std::string> AdBlockBaseService::HiddenClassIdSelectors(
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& exceptions) {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
-  return base::JSONReader::Read(
-      ad_block_client_->hiddenClassIdSelectors(classes, ids, exceptions));
+  return ad_block_client_->getHiddenClassIdSelectors(classes, ids, exceptions);
+}
+
+// static
+uint64_t AdBlockBaseService::GetEngineGeneration() {
+  return g_engine_generation.load(std::memory_order_acquire);
+}
+
+// static
+void AdBlockBaseService::IncrementEngineGeneration() {
+  g_engine_generation.fetch_add(1, std::memory_order_acq_rel);
 }
 
 void AdBlockBaseService::GetDATFileData(const base::FilePath& dat_file_path) {
@@ -224,19 +348,16 @@ void AdBlockBaseService::GetDATFileData(const base::FilePath& dat_file_path) {
                      weak_factory_.GetWeakPtr()));
 }
 
-void AdBlockBaseService::OnGetDATFileData(GetDATFileDataResult result) {
-  if (result.second.empty()) {
-    LOG(ERROR) << "Could not obtain ad block data";
-    return;
-  }
-  if (!result.first.get()) {
-    LOG(ERROR) << "Failed to deserialize ad block data";
+void AdBlockBaseService::OnGetDATFileData(
+    std::unique_ptr<adblock::Engine> ad_block_client) {
+  if (!ad_block_client) {
+    LOG(ERROR) << "Could not load ad block data";
     return;
   }
   GetTaskRunner()->PostTask(
       FROM_HERE, base::BindOnce(&AdBlockBaseService::UpdateAdBlockClient,
                                 base::Unretained(this),
-                                std::move(result.first)));
+                                std::move(ad_block_client)));
 }
 
 void AdBlockBaseService::UpdateAdBlockClient(
@@ -245,6 +366,7 @@ void AdBlockBaseService::UpdateAdBlockClient(
   ad_block_client_ = std::move(ad_block_client);
   AddKnownTagsToAdBlockInstance();
   AddKnownResourcesToAdBlockInstance();
+  IncrementEngineGeneration();
 }
 
 void AdBlockBaseService::AddKnownTagsToAdBlockInstance() {
@@ -271,6 +393,7 @@ void AdBlockBaseService::ResetForTest(const std::string& rules,
     resources_ = resources;
   }
   AddKnownResourcesToAdBlockInstance();
+  IncrementEngineGeneration();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
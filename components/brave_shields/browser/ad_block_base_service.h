@@ -13,14 +13,17 @@
 #include <utility>
 #include <vector>
 
+#include "base/callback_forward.h"
 #include "base/files/file_path.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
 #include "base/values.h"
+#include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
 #include "brave/components/brave_component_updater/browser/dat_file_util.h"
 #include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
 
+class AdBlockBaseServiceTest;
 class AdBlockServiceTest;
 class BraveAdBlockTPNetworkDelegateHelperTest;
 
@@ -31,13 +34,36 @@ class Engine;
 
 namespace brave_shields {
 
+// The request properties handed to an adblock engine. They only depend on the
+// request, so they are computed once and shared by every engine (default,
+// regional and custom) the request is checked against.
+struct AdBlockEngineRequest {
+  AdBlockEngineRequest(const GURL& url,
+                       blink::mojom::ResourceType resource_type,
+                       const std::string& tab_host);
+  ~AdBlockEngineRequest();
+
+  const std::string url;
+  const std::string host;
+  const std::string tab_host;
+  const bool is_third_party;
+  const std::string resource_type;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockEngineRequest);
+};
+
+// The outcome of matching a request against one or more engines.
+struct AdBlockMatchResult {
+  bool did_match_rule = false;
+  bool did_match_exception = false;
+  bool did_match_important = false;
+  std::string mock_data_url;
+};
+
 // The base class of the brave shields service in charge of ad-block
 // checking and init.
 class AdBlockBaseService : public BaseBraveShieldsService {
  public:
-  using GetDATFileDataResult =
-      brave_component_updater::LoadDATFileDataResult<adblock::Engine>;
-
   explicit AdBlockBaseService(BraveComponent::Delegate* delegate);
   ~AdBlockBaseService() override;
 
@@ -52,18 +78,43 @@ class AdBlockBaseService : public BaseBraveShieldsService {
       const GURL& url,
       blink::mojom::ResourceType resource_type,
       const std::string& tab_host);
+  void MatchRequest(const AdBlockEngineRequest& request,
+                    bool* did_match_rule,
+                    bool* did_match_exception,
+                    bool* did_match_important,
+                    std::string* mock_data_url);
+  base::Optional<std::string> GetCspDirectivesForRequest(
+      const AdBlockEngineRequest& request);
+  // Matches |request| against |services| as if MatchRequest was called on each
+  // of them in turn, stopping at the first important match. With enough
+  // engines, they are first all matched concurrently on the thread pool. An
+  // engine only depends on the engines before it once one of them matched,
+  // so only those requests query the remaining engines again.
+  static void MatchRequestInOrder(
+      const std::vector<AdBlockBaseService*>& services,
+      const AdBlockEngineRequest& request,
+      bool* did_match_rule,
+      bool* did_match_exception,
+      bool* did_match_important,
+      std::string* mock_data_url);
   void AddResources(const std::string& resources);
   void EnableTag(const std::string& tag, bool enabled);
   bool TagExists(const std::string& tag);
 
-  virtual base::Optional<base::Value> UrlCosmeticResources(
-      const std::string& url);
-  virtual base::Optional<base::Value> HiddenClassIdSelectors(
+  virtual CosmeticResources UrlCosmeticResources(const std::string& url);
+  std::vector<std::string> HiddenClassIdSelectors(
       const std::vector<std::string>& classes,
       const std::vector<std::string>& ids,
       const std::vector<std::string>& exceptions);
 
+  // Returns a number which is incremented whenever the rules, tags or
+  // resources of any ad block engine change, so that results derived from
+  // the engines can be cached.
+  static uint64_t GetEngineGeneration();
+  static void IncrementEngineGeneration();
+
  protected:
+  friend class ::AdBlockBaseServiceTest;
   friend class ::AdBlockServiceTest;
   friend class ::BraveAdBlockTPNetworkDelegateHelperTest;
 
@@ -77,9 +128,15 @@ class AdBlockBaseService : public BaseBraveShieldsService {
   std::unique_ptr<adblock::Engine> ad_block_client_;
 
  private:
+  void MatchRequestOnEngine(const AdBlockEngineRequest& request,
+                            AdBlockMatchResult* result);
+  static void MatchRequestOnWorker(AdBlockBaseService* service,
+                                   const AdBlockEngineRequest* request,
+                                   AdBlockMatchResult* result,
+                                   base::OnceClosure done);
   void UpdateAdBlockClient(
       std::unique_ptr<adblock::Engine> ad_block_client);
-  void OnGetDATFileData(GetDATFileDataResult result);
+  void OnGetDATFileData(std::unique_ptr<adblock::Engine> ad_block_client);
   void OnPreferenceChanges(const std::string& pref_name);
 
   std::vector<std::string> tags_;
@@ -0,0 +1,140 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_base_service.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/test/task_environment.h"
+#include "base/timer/elapsed_timer.h"
+#include "brave/test/base/testing_brave_component_updater_delegate.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+using brave_shields::AdBlockBaseService;
+using brave_shields::AdBlockEngineRequest;
+using brave_shields::AdBlockMatchResult;
+
+class AdBlockBaseServiceTest : public testing::Test {
+ protected:
+  AdBlockBaseService* AddService(const std::string& rules) {
+    services_.push_back(std::make_unique<AdBlockBaseService>(&delegate_));
+    services_.back()->ResetForTest(rules, "");
+    return services_.back().get();
+  }
+
+  std::vector<AdBlockBaseService*> GetServices() {
+    std::vector<AdBlockBaseService*> services;
+    for (const auto& service : services_)
+      services.push_back(service.get());
+    return services;
+  }
+
+  // Queries every engine in turn, the way the services did before they were
+  // matched concurrently.
+  AdBlockMatchResult MatchSerially(const AdBlockEngineRequest& request) {
+    AdBlockMatchResult result;
+    for (const auto& service : services_) {
+      service->MatchRequest(request, &result.did_match_rule,
+                            &result.did_match_exception,
+                            &result.did_match_important,
+                            &result.mock_data_url);
+      if (result.did_match_important)
+        break;
+    }
+    return result;
+  }
+
+  AdBlockMatchResult MatchInOrder(const AdBlockEngineRequest& request) {
+    AdBlockMatchResult result;
+    AdBlockBaseService::MatchRequestInOrder(
+        GetServices(), request, &result.did_match_rule,
+        &result.did_match_exception, &result.did_match_important,
+        &result.mock_data_url);
+    return result;
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  TestingBraveComponentUpdaterDelegate delegate_;
+  std::vector<std::unique_ptr<AdBlockBaseService>> services_;
+};
+
+TEST_F(AdBlockBaseServiceTest, MatchRequestInOrderMatchesSerialQueries) {
+  AddService(
+      "||ads.example.com^\n"
+      "||late-important.example.com^\n"
+      "||important.example.com^$important\n");
+  AddService(
+      "@@||ads.example.com^\n"
+      "||tracker.example.com^\n"
+      "||late-important.example.com^$important\n");
+  AddService("@@||tracker.example.com/allowed^\n");
+  AddService(
+      "||custom.example.com^\n"
+      "@@||important.example.com^\n");
+
+  const char* urls[] = {
+      "https://nothing.example.com/script.js",
+      "https://ads.example.com/script.js",
+      "https://tracker.example.com/script.js",
+      "https://tracker.example.com/allowed/script.js",
+      "https://late-important.example.com/script.js",
+      "https://important.example.com/script.js",
+      "https://custom.example.com/script.js",
+  };
+  for (const char* url : urls) {
+    SCOPED_TRACE(url);
+    const AdBlockEngineRequest request(
+        GURL(url), blink::mojom::ResourceType::kScript, "example.org");
+
+    const AdBlockMatchResult expected = MatchSerially(request);
+    const AdBlockMatchResult result = MatchInOrder(request);
+    EXPECT_EQ(expected.did_match_rule, result.did_match_rule);
+    EXPECT_EQ(expected.did_match_exception, result.did_match_exception);
+    EXPECT_EQ(expected.did_match_important, result.did_match_important);
+    EXPECT_EQ(expected.mock_data_url, result.mock_data_url);
+  }
+}
+
+// Benchmark, run manually with
+// npm run test -- brave_unit_tests
+//     --filter=AdBlockBaseServiceTest.DISABLED_Benchmark
+//     --gtest_also_run_disabled_tests
+TEST_F(AdBlockBaseServiceTest, DISABLED_Benchmark) {
+  const int kRulesPerEngine = 20000;
+  const int kRequests = 1000;
+
+  for (int engine = 0; engine < 8; ++engine) {
+    std::string rules;
+    for (int i = 0; i < kRulesPerEngine; ++i)
+      rules += base::StringPrintf("||host%d-%d.example.com^\n", engine, i);
+    AddService(rules);
+
+    std::vector<std::unique_ptr<AdBlockEngineRequest>> requests;
+    for (int i = 0; i < kRequests; ++i) {
+      requests.push_back(std::make_unique<AdBlockEngineRequest>(
+          GURL(base::StringPrintf("https://site%d.example.net/a/b.js?q=%d",
+                                  i % 50, i)),
+          blink::mojom::ResourceType::kScript, "example.org"));
+    }
+
+    base::ElapsedTimer serial_timer;
+    for (const auto& request : requests)
+      MatchSerially(*request);
+    const base::TimeDelta serial_time = serial_timer.Elapsed();
+
+    base::ElapsedTimer in_order_timer;
+    for (const auto& request : requests)
+      MatchInOrder(*request);
+    const base::TimeDelta in_order_time = in_order_timer.Elapsed();
+
+    LOG(INFO) << services_.size() << " engines, " << kRequests
+              << " requests: serial " << serial_time.InMicroseconds()
+              << " us, in order " << in_order_time.InMicroseconds() << " us";
+  }
+}
@@ -0,0 +1,63 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources_cache.h"
+
+#include <utility>
+
+namespace brave_shields {
+
+AdBlockCosmeticResourcesCache::AdBlockCosmeticResourcesCache(size_t size)
+    : entries_(size) {
+  // The cache is created on the UI thread but only used on the ad block task
+  // runner.
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+AdBlockCosmeticResourcesCache::~AdBlockCosmeticResourcesCache() = default;
+
+scoped_refptr<const SharedCosmeticResources>
+AdBlockCosmeticResourcesCache::Get(const std::string& key,
+                                   uint64_t generation) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  if (generation != generation_) {
+    UpdateGeneration(generation);
+    return nullptr;
+  }
+
+  auto it = entries_.Get(key);
+  if (it == entries_.end())
+    return nullptr;
+  return it->second;
+}
+
+void AdBlockCosmeticResourcesCache::Put(
+    const std::string& key,
+    uint64_t generation,
+    scoped_refptr<const SharedCosmeticResources> resources) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(resources);
+  if (!UpdateGeneration(generation))
+    return;
+  entries_.Put(key, std::move(resources));
+}
+
+void AdBlockCosmeticResourcesCache::Clear() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  entries_.Clear();
+}
+
+bool AdBlockCosmeticResourcesCache::UpdateGeneration(uint64_t generation) {
+  if (generation < generation_)
+    return false;
+  if (generation > generation_) {
+    entries_.Clear();
+    generation_ = generation;
+  }
+  return true;
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,63 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_CACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/sequence_checker.h"
+#include "brave/components/brave_shields/browser/ad_block_service_helper.h"
+
+namespace brave_shields {
+
+// Merged cosmetic resources, shared between the cache and its callers rather
+// than copied on every hit.
+using SharedCosmeticResources = base::RefCountedData<CosmeticResources>;
+
+// MRU cache of merged cosmetic resources. Every entry is tagged with the
+// generation of the ad block engines it was computed from, and entries from
+// an older generation are dropped as soon as a newer one is seen, so the
+// cache never outlives a change to the enabled lists or their rules.
+class AdBlockCosmeticResourcesCache {
+ public:
+  explicit AdBlockCosmeticResourcesCache(size_t size);
+  ~AdBlockCosmeticResourcesCache();
+
+  // Returns the resources cached for |key| if they were computed for
+  // |generation|, or null.
+  scoped_refptr<const SharedCosmeticResources> Get(const std::string& key,
+                                                   uint64_t generation);
+
+  // Caches |resources| for |key|, unless they were computed for a generation
+  // older than the one already cached.
+  void Put(const std::string& key,
+           uint64_t generation,
+           scoped_refptr<const SharedCosmeticResources> resources);
+
+  void Clear();
+
+ private:
+  // Drops every entry if |generation| is newer than the cached one. Returns
+  // false if |generation| is older.
+  bool UpdateGeneration(uint64_t generation);
+
+  base::MRUCache<std::string, scoped_refptr<const SharedCosmeticResources>>
+      entries_;
+  uint64_t generation_ = 0;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockCosmeticResourcesCache);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_CACHE_H_
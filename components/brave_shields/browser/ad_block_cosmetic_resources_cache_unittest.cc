@@ -0,0 +1,97 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <string>
+#include <utility>
+
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources_cache.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_shields {
+
+using ::testing::ElementsAre;
+
+namespace {
+
+scoped_refptr<const SharedCosmeticResources> MakeResources(
+    const std::string& selector) {
+  CosmeticResources resources;
+  resources.hide_selectors = {selector};
+  return base::MakeRefCounted<SharedCosmeticResources>(std::move(resources));
+}
+
+}  // namespace
+
+TEST(AdBlockCosmeticResourcesCacheTest, GetAndPut) {
+  AdBlockCosmeticResourcesCache cache(10);
+
+  EXPECT_FALSE(cache.Get("a.com", 1));
+  cache.Put("a.com", 1, MakeResources("a"));
+  scoped_refptr<const SharedCosmeticResources> resources =
+      cache.Get("a.com", 1);
+  ASSERT_TRUE(resources);
+  EXPECT_THAT(resources->data.hide_selectors, ElementsAre("a"));
+  EXPECT_FALSE(cache.Get("b.com", 1));
+}
+
+TEST(AdBlockCosmeticResourcesCacheTest, SharesCachedResources) {
+  AdBlockCosmeticResourcesCache cache(10);
+  scoped_refptr<const SharedCosmeticResources> resources = MakeResources("a");
+
+  cache.Put("a.com", 1, resources);
+  EXPECT_EQ(resources, cache.Get("a.com", 1));
+  EXPECT_EQ(resources, cache.Get("a.com", 1));
+}
+
+TEST(AdBlockCosmeticResourcesCacheTest, NewerGenerationDropsEntries) {
+  AdBlockCosmeticResourcesCache cache(10);
+
+  cache.Put("a.com", 1, MakeResources("a"));
+  cache.Put("b.com", 1, MakeResources("b"));
+  EXPECT_FALSE(cache.Get("a.com", 2));
+  // The entries of the older generation are gone for good.
+  EXPECT_FALSE(cache.Get("b.com", 2));
+  EXPECT_FALSE(cache.Get("b.com", 1));
+
+  cache.Put("a.com", 2, MakeResources("c"));
+  scoped_refptr<const SharedCosmeticResources> resources =
+      cache.Get("a.com", 2);
+  ASSERT_TRUE(resources);
+  EXPECT_THAT(resources->data.hide_selectors, ElementsAre("c"));
+}
+
+TEST(AdBlockCosmeticResourcesCacheTest, OlderGenerationIsNotCached) {
+  AdBlockCosmeticResourcesCache cache(10);
+
+  cache.Put("a.com", 2, MakeResources("a"));
+  // Resources computed before the engines changed must not be cached.
+  cache.Put("b.com", 1, MakeResources("b"));
+  EXPECT_FALSE(cache.Get("b.com", 2));
+  EXPECT_TRUE(cache.Get("a.com", 2));
+}
+
+TEST(AdBlockCosmeticResourcesCacheTest, EvictsLeastRecentlyUsed) {
+  AdBlockCosmeticResourcesCache cache(2);
+
+  cache.Put("a.com", 1, MakeResources("a"));
+  cache.Put("b.com", 1, MakeResources("b"));
+  EXPECT_TRUE(cache.Get("a.com", 1));
+  cache.Put("c.com", 1, MakeResources("c"));
+
+  EXPECT_TRUE(cache.Get("a.com", 1));
+  EXPECT_FALSE(cache.Get("b.com", 1));
+  EXPECT_TRUE(cache.Get("c.com", 1));
+}
+
+TEST(AdBlockCosmeticResourcesCacheTest, Clear) {
+  AdBlockCosmeticResourcesCache cache(10);
+
+  cache.Put("a.com", 1, MakeResources("a"));
+  cache.Clear();
+  EXPECT_FALSE(cache.Get("a.com", 1));
+}
+
+}  // namespace brave_shields
@@ -5,6 +5,7 @@
 
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 
+#include <iterator>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -84,6 +85,7 @@ void AdBlockRegionalServiceManager::StartRegionalServices() {
       }
     }
   }
+  AdBlockBaseService::IncrementEngineGeneration();
 
   initialized_ = true;
 }
@@ -115,35 +117,37 @@ bool AdBlockRegionalServiceManager::Start() {
   return true;
 }
 
-void AdBlockRegionalServiceManager::ShouldStartRequest(
-    const GURL& url,
-    blink::mojom::ResourceType resource_type,
-    const std::string& tab_host,
+void AdBlockRegionalServiceManager::MatchRequest(
+    AdBlockBaseService* default_service,
+    AdBlockBaseService* custom_service,
+    const AdBlockEngineRequest& request,
     bool* did_match_rule,
     bool* did_match_exception,
     bool* did_match_important,
     std::string* mock_data_url) {
   base::AutoLock lock(regional_services_lock_);
 
+  std::vector<AdBlockBaseService*> services;
+  services.reserve(regional_services_.size() + 2);
+  services.push_back(default_service);
   for (const auto& regional_service : regional_services_) {
-    regional_service.second->ShouldStartRequest(
-        url, resource_type, tab_host, did_match_rule, did_match_exception,
-        did_match_important, mock_data_url);
-    if (did_match_important && *did_match_important) {
-      return;
-    }
+    services.push_back(regional_service.second.get());
   }
+  services.push_back(custom_service);
+
+  AdBlockBaseService::MatchRequestInOrder(services, request, did_match_rule,
+                                          did_match_exception,
+                                          did_match_important, mock_data_url);
 }
 
-base::Optional<std::string> AdBlockRegionalServiceManager::GetCspDirectives(
-    const GURL& url,
-    blink::mojom::ResourceType resource_type,
-    const std::string& tab_host) {
+base::Optional<std::string>
+AdBlockRegionalServiceManager::GetCspDirectivesForRequest(
+    const AdBlockEngineRequest& request) {
   base::Optional<std::string> csp_directives = base::nullopt;
 
   for (const auto& regional_service : regional_services_) {
     const auto directive =
-        regional_service.second->GetCspDirectives(url, resource_type, tab_host);
+        regional_service.second->GetCspDirectivesForRequest(request);
     MergeCspDirectiveInto(directive, &csp_directives);
   }
 
@@ -191,6 +195,7 @@ void AdBlockRegionalServiceManager::EnableFilterList(
       it->second->Unregister();
       regional_services_.erase(it);
     }
+    AdBlockBaseService::IncrementEngineGeneration();
   }
 
   // Update preferences to reflect enabled/disabled state of specified
@@ -201,62 +206,49 @@ void AdBlockRegionalServiceManager::EnableFilterList(
                      base::Unretained(this), uuid, enabled));
 }
 
-base::Optional<base::Value>
-AdBlockRegionalServiceManager::UrlCosmeticResources(
-        const std::string& url) {
+std::vector<std::string>
+AdBlockRegionalServiceManager::GetEnabledFilterListUUIDs() {
+  base::AutoLock lock(regional_services_lock_);
+  std::vector<std::string> uuids;
+  uuids.reserve(regional_services_.size());
+  for (const auto& regional_service : regional_services_)
+    uuids.push_back(regional_service.first);
+  return uuids;
+}
+
+CosmeticResources AdBlockRegionalServiceManager::UrlCosmeticResources(
+    const std::string& url) {
   base::AutoLock lock(regional_services_lock_);
   auto it = regional_services_.begin();
   if (it == regional_services_.end()) {
-    return base::Optional<base::Value>();
+    return CosmeticResources();
   }
-  base::Optional<base::Value> first_value =
-      it->second->UrlCosmeticResources(url);
-
-  for ( ; it != regional_services_.end(); it++) {
-    base::Optional<base::Value> next_value =
-        it->second->UrlCosmeticResources(url);
-    if (first_value) {
-      if (next_value) {
-        MergeResourcesInto(std::move(*next_value), &*first_value, false);
-      }
-    } else {
-      first_value = std::move(next_value);
-    }
+  CosmeticResources resources = it->second->UrlCosmeticResources(url);
+
+  for (++it; it != regional_services_.end(); ++it) {
+    MergeResourcesInto(it->second->UrlCosmeticResources(url), &resources,
+                       /*force_hide=*/false);
   }
 
-  return first_value;
+  return resources;
 }
 
-base::Optional<base::Value>
-AdBlockRegionalServiceManager::HiddenClassIdSelectors(
-        const std::vector<std::string>& classes,
-        const std::vector<std::string>& ids,
-        const std::vector<std::string>& exceptions) {
+std::vector<std::string> AdBlockRegionalServiceManager::HiddenClassIdSelectors(
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& exceptions) {
   base::AutoLock lock(regional_services_lock_);
-  auto it = regional_services_.begin();
-  if (it == regional_services_.end()) {
-    return base::Optional<base::Value>();
-  }
-  base::Optional<base::Value> first_value =
-      it->second->HiddenClassIdSelectors(classes, ids, exceptions);
-
-  for ( ; it != regional_services_.end(); it++) {
-    base::Optional<base::Value> next_value =
-        it->second->HiddenClassIdSelectors(classes, ids, exceptions);
-    if (first_value && first_value->is_list()) {
-      if (next_value && next_value->is_list()) {
-        for (auto i = next_value->GetList().begin();
-                i < next_value->GetList().end();
-                i++) {
-          first_value->Append(std::move(*i));
-        }
-      }
-    } else {
-      first_value = std::move(next_value);
-    }
+  std::vector<std::string> selectors;
+  for (const auto& regional_service : regional_services_) {
+    std::vector<std::string> next_selectors =
+        regional_service.second->HiddenClassIdSelectors(classes, ids,
+                                                        exceptions);
+    selectors.insert(selectors.end(),
+                     std::make_move_iterator(next_selectors.begin()),
+                     std::make_move_iterator(next_selectors.end()));
   }
 
-  return first_value;
+  return selectors;
 }
 
 void AdBlockRegionalServiceManager::SetRegionalCatalog(
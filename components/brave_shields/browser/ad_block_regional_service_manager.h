@@ -18,6 +18,7 @@
 #include "base/values.h"
 #include "brave/components/adblock_rust_ffi/src/wrapper.h"
 #include "brave/components/brave_component_updater/browser/brave_component.h"
+#include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
 #include "url/gurl.h"
 
@@ -31,7 +32,9 @@ using brave_component_updater::BraveComponent;
 
 namespace brave_shields {
 
+class AdBlockBaseService;
 class AdBlockRegionalService;
+struct AdBlockEngineRequest;
 
 // The AdBlock regional service manager, in charge of initializing and
 // managing regional AdBlock clients.
@@ -47,27 +50,28 @@ class AdBlockRegionalServiceManager {
 
   bool IsInitialized() const;
   bool Start();
-  void ShouldStartRequest(const GURL& url,
-                          blink::mojom::ResourceType resource_type,
-                          const std::string& tab_host,
-                          bool* did_match_rule,
-                          bool* did_match_exception,
-                          bool* did_match_important,
-                          std::string* mock_data_url);
-  base::Optional<std::string> GetCspDirectives(
-      const GURL& url,
-      blink::mojom::ResourceType resource_type,
-      const std::string& tab_host);
+  // Matches |request| against |default_service|, every enabled regional list
+  // and |custom_service|, in that order.
+  void MatchRequest(AdBlockBaseService* default_service,
+                    AdBlockBaseService* custom_service,
+                    const AdBlockEngineRequest& request,
+                    bool* did_match_rule,
+                    bool* did_match_exception,
+                    bool* did_match_important,
+                    std::string* mock_data_url);
+  base::Optional<std::string> GetCspDirectivesForRequest(
+      const AdBlockEngineRequest& request);
   void EnableTag(const std::string& tag, bool enabled);
   void AddResources(const std::string& resources);
   void EnableFilterList(const std::string& uuid, bool enabled);
-
-  base::Optional<base::Value> UrlCosmeticResources(
-          const std::string& url);
-  base::Optional<base::Value> HiddenClassIdSelectors(
-          const std::vector<std::string>& classes,
-          const std::vector<std::string>& ids,
-          const std::vector<std::string>& exceptions);
+  // Returns the UUIDs of the enabled filter lists, in order.
+  std::vector<std::string> GetEnabledFilterListUUIDs();
+
+  CosmeticResources UrlCosmeticResources(const std::string& url);
+  std::vector<std::string> HiddenClassIdSelectors(
+      const std::vector<std::string>& classes,
+      const std::vector<std::string>& ids,
+      const std::vector<std::string>& exceptions);
 
  private:
   friend class ::AdBlockServiceTest;
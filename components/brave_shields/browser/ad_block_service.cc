@@ -6,16 +6,19 @@
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 
 #include <algorithm>
+#include <iterator>
 #include <utility>
 
 #include "base/base_paths.h"
 #include "base/bind.h"
-#include "base/feature_list.h"
 #include "base/files/file_path.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/strings/strcat.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/thread_restrictions.h"
 #include "brave/components/adblock_rust_ffi/src/wrapper.h"
@@ -23,15 +26,16 @@
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 #include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
-#include "brave/components/brave_shields/common/features.h"
 #include "brave/components/brave_shields/common/pref_names.h"
 #include "components/prefs/pref_change_registrar.h"
 #include "components/prefs/pref_registry_simple.h"
 #include "components/prefs/pref_service.h"
 #include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "url/gurl.h"
 
 #define DAT_FILE "rs-ABPFilterParserData.dat"
 #define REGIONAL_CATALOG "regional_catalog.json"
+#define COSMETIC_RESOURCES_CACHE_SIZE 100
 
 namespace brave_shields {
 
@@ -70,119 +74,102 @@ void AdBlockService::ShouldStartRequest(
     bool* did_match_exception,
     bool* did_match_important,
     std::string* mock_data_url) {
-  AdBlockBaseService::ShouldStartRequest(
-      url, resource_type, tab_host, did_match_rule, did_match_exception,
-      did_match_important, mock_data_url);
-  if (did_match_important && *did_match_important) {
-    return;
-  }
-
-  regional_service_manager()->ShouldStartRequest(
-      url, resource_type, tab_host, did_match_rule, did_match_exception,
-      did_match_important, mock_data_url);
-  if (did_match_important && *did_match_important) {
-    return;
-  }
+  // Every engine sees the same request, so prepare it only once.
+  const AdBlockEngineRequest request(url, resource_type, tab_host);
 
-  custom_filters_service()->ShouldStartRequest(
-      url, resource_type, tab_host, did_match_rule, did_match_exception,
-      did_match_important, mock_data_url);
+  regional_service_manager()->MatchRequest(
+      this, custom_filters_service(), request, did_match_rule,
+      did_match_exception, did_match_important, mock_data_url);
 }
 
 base::Optional<std::string> AdBlockService::GetCspDirectives(
     const GURL& url,
     blink::mojom::ResourceType resource_type,
     const std::string& tab_host) {
-  auto csp_directives =
-      AdBlockBaseService::GetCspDirectives(url, resource_type, tab_host);
+  const AdBlockEngineRequest request(url, resource_type, tab_host);
+  auto csp_directives = GetCspDirectivesForRequest(request);
 
-  const auto regional_csp = regional_service_manager()->GetCspDirectives(
-      url, resource_type, tab_host);
+  const auto regional_csp =
+      regional_service_manager()->GetCspDirectivesForRequest(request);
   MergeCspDirectiveInto(regional_csp, &csp_directives);
 
   const auto custom_csp =
-      custom_filters_service()->GetCspDirectives(url, resource_type, tab_host);
+      custom_filters_service()->GetCspDirectivesForRequest(request);
   MergeCspDirectiveInto(custom_csp, &csp_directives);
 
   return csp_directives;
 }
 
-base::Optional<base::Value> AdBlockService::UrlCosmeticResources(
+CosmeticResources AdBlockService::UrlCosmeticResources(
     const std::string& url) {
-  base::Optional<base::Value> resources =
-      AdBlockBaseService::UrlCosmeticResources(url);
+  return SharedUrlCosmeticResources(url)->data;
+}
 
-  if (!resources || !resources->is_dict()) {
-    return resources;
+scoped_refptr<const SharedCosmeticResources>
+AdBlockService::SharedUrlCosmeticResources(const std::string& url) {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  // Cosmetic filters are selected by host, so entries are shared between the
+  // pages of a host. A $generichide exception which only matches some of
+  // those pages applies to all of them until the entry is evicted.
+  const GURL gurl(url);
+  std::string key;
+  if (gurl.is_valid() && gurl.has_host()) {
+    key = base::StrCat(
+        {gurl.host(), " ",
+         base::JoinString(
+             regional_service_manager()->GetEnabledFilterListUUIDs(), ",")});
+  }
+  // Read before querying the engines so that a change made while merging
+  // invalidates the entry.
+  const uint64_t generation = GetEngineGeneration();
+
+  if (!key.empty()) {
+    scoped_refptr<const SharedCosmeticResources> cached_resources =
+        cosmetic_resources_cache_.Get(key, generation);
+    UMA_HISTOGRAM_BOOLEAN("Brave.Shields.CosmeticResourcesCacheHit",
+                          !!cached_resources);
+    if (cached_resources)
+      return cached_resources;
   }
 
-  base::Optional<base::Value> regional_resources =
-      regional_service_manager()->UrlCosmeticResources(url);
+  CosmeticResources resources = AdBlockBaseService::UrlCosmeticResources(url);
 
-  if (regional_resources && regional_resources->is_dict()) {
-    MergeResourcesInto(std::move(*regional_resources), &*resources,
-                       /*force_hide=*/false);
-  }
+  MergeResourcesInto(regional_service_manager()->UrlCosmeticResources(url),
+                     &resources, /*force_hide=*/false);
 
-  base::Optional<base::Value> custom_resources =
-      custom_filters_service()->UrlCosmeticResources(url);
+  MergeResourcesInto(custom_filters_service()->UrlCosmeticResources(url),
+                     &resources, /*force_hide=*/true);
 
-  if (custom_resources && custom_resources->is_dict()) {
-    MergeResourcesInto(std::move(*custom_resources), &*resources,
-                       /*force_hide=*/true);
-  }
+  auto shared_resources =
+      base::MakeRefCounted<SharedCosmeticResources>(std::move(resources));
+  if (!key.empty())
+    cosmetic_resources_cache_.Put(key, generation, shared_resources);
 
-  return resources;
+  return shared_resources;
 }
 
-base::Optional<base::Value> AdBlockService::HiddenClassIdSelectors(
+void AdBlockService::HiddenClassIdSelectors(
     const std::vector<std::string>& classes,
     const std::vector<std::string>& ids,
-    const std::vector<std::string>& exceptions) {
-  base::Optional<base::Value> hide_selectors =
+    const std::vector<std::string>& exceptions,
+    std::vector<std::string>* hide_selectors,
+    std::vector<std::string>* force_hide_selectors) {
+  DCHECK(hide_selectors);
+  DCHECK(force_hide_selectors);
+
+  *hide_selectors =
       AdBlockBaseService::HiddenClassIdSelectors(classes, ids, exceptions);
 
-  base::Optional<base::Value> regional_selectors =
+  std::vector<std::string> regional_selectors =
       regional_service_manager()->HiddenClassIdSelectors(classes, ids,
                                                          exceptions);
+  hide_selectors->insert(hide_selectors->end(),
+                         std::make_move_iterator(regional_selectors.begin()),
+                         std::make_move_iterator(regional_selectors.end()));
 
-  base::Optional<base::Value> custom_selectors =
+  *force_hide_selectors =
       custom_filters_service()->HiddenClassIdSelectors(classes, ids,
                                                        exceptions);
-
-  if (hide_selectors && hide_selectors->is_list()) {
-    if (regional_selectors && regional_selectors->is_list()) {
-      for (auto i = regional_selectors->GetList().begin();
-           i < regional_selectors->GetList().end(); i++) {
-        hide_selectors->Append(std::move(*i));
-      }
-    }
-  } else {
-    hide_selectors = std::move(regional_selectors);
-  }
-
-#if !defined(OS_ANDROID) && !defined(CHROME_OS)
-  if (!base::FeatureList::IsEnabled(
-          brave_shields::features::kBraveAdblockCosmeticFilteringNative)) {
-    auto result_list = std::make_unique<base::ListValue>();
-    if (hide_selectors && hide_selectors->is_list()) {
-      result_list->Append(std::move(*hide_selectors));
-    }
-    if (custom_selectors && custom_selectors->is_list()) {
-      result_list->Append(std::move(*custom_selectors));
-    }
-
-    return std::move(*result_list);
-  }
-#endif
-
-  if (!hide_selectors || !hide_selectors->is_list())
-    hide_selectors = base::ListValue();
-
-  if (custom_selectors && custom_selectors->is_list())
-    hide_selectors->Append(std::move(*custom_selectors));
-
-  return hide_selectors;
 }
 
 AdBlockRegionalServiceManager* AdBlockService::regional_service_manager() {
@@ -203,7 +190,9 @@ AdBlockService::custom_filters_service() {
 
 AdBlockService::AdBlockService(
     brave_component_updater::BraveComponent::Delegate* delegate)
-    : AdBlockBaseService(delegate), component_delegate_(delegate) {}
+    : AdBlockBaseService(delegate),
+      cosmetic_resources_cache_(COSMETIC_RESOURCES_CACHE_SIZE),
+      component_delegate_(delegate) {}
 
 AdBlockService::~AdBlockService() {}
 
@@ -15,6 +15,7 @@
 #include "base/optional.h"
 #include "base/values.h"
 #include "brave/components/brave_shields/browser/ad_block_base_service.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources_cache.h"
 #include "components/keyed_service/core/keyed_service.h"
 #include "components/prefs/pref_registry_simple.h"
 #include "content/public/browser/browser_thread.h"
@@ -60,12 +61,19 @@ class AdBlockService : public AdBlockBaseService {
       const GURL& url,
       blink::mojom::ResourceType resource_type,
       const std::string& tab_host);
-  base::Optional<base::Value> UrlCosmeticResources(
-      const std::string& url) override;
-  base::Optional<base::Value> HiddenClassIdSelectors(
-      const std::vector<std::string>& classes,
-      const std::vector<std::string>& ids,
-      const std::vector<std::string>& exceptions) override;
+  CosmeticResources UrlCosmeticResources(const std::string& url) override;
+  // Returns the same resources as UrlCosmeticResources without copying them.
+  // Results are cached per host and set of enabled regional lists until any
+  // of the engines change.
+  scoped_refptr<const SharedCosmeticResources> SharedUrlCosmeticResources(
+      const std::string& url);
+  // Selectors from the default and regional lists are returned in
+  // |hide_selectors|, those from custom filters in |force_hide_selectors|.
+  void HiddenClassIdSelectors(const std::vector<std::string>& classes,
+                              const std::vector<std::string>& ids,
+                              const std::vector<std::string>& exceptions,
+                              std::vector<std::string>* hide_selectors,
+                              std::vector<std::string>* force_hide_selectors);
 
   AdBlockRegionalServiceManager* regional_service_manager();
   AdBlockCustomFiltersService* custom_filters_service();
@@ -92,6 +100,7 @@ class AdBlockService : public AdBlockBaseService {
       regional_service_manager_;
   std::unique_ptr<brave_shields::AdBlockCustomFiltersService>
       custom_filters_service_;
+  AdBlockCosmeticResourcesCache cosmetic_resources_cache_;
 
   BraveComponent::Delegate* component_delegate_;
 
@@ -7,6 +7,7 @@
 #define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_SERVICE_HELPER_H_
 
 #include <stdint.h>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -15,6 +16,27 @@
 
 namespace brave_shields {
 
+// Cosmetic filtering resources specific to a url, merged across all of the
+// enabled engines. Selectors from custom filters end up in
+// |force_hide_selectors| so that they are applied regardless of first party
+// content.
+struct CosmeticResources {
+  CosmeticResources();
+  explicit CosmeticResources(adblock::UrlCosmeticResources&& resources);
+  CosmeticResources(const CosmeticResources& other);
+  CosmeticResources& operator=(const CosmeticResources& other);
+  CosmeticResources(CosmeticResources&& other);
+  CosmeticResources& operator=(CosmeticResources&& other);
+  ~CosmeticResources();
+
+  std::vector<std::string> hide_selectors;
+  std::map<std::string, std::vector<std::string>> style_selectors;
+  std::vector<std::string> exceptions;
+  std::string injected_script;
+  bool generichide = false;
+  std::vector<std::string> force_hide_selectors;
+};
+
 std::vector<adblock::FilterList>::const_iterator FindAdBlockFilterListByUUID(
     const std::vector<adblock::FilterList>& region_lists,
     const std::string& uuid);
@@ -28,7 +50,9 @@ std::vector<adblock::FilterList> RegionalCatalogFromJSON(
 void MergeCspDirectiveInto(base::Optional<std::string> from,
                            base::Optional<std::string>* into);
 
-void MergeResourcesInto(base::Value from, base::Value* into, bool force_hide);
+void MergeResourcesInto(CosmeticResources from,
+                        CosmeticResources* into,
+                        bool force_hide);
 
 }  // namespace brave_shields
 
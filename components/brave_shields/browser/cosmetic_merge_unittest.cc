@@ -3,308 +3,204 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this file,
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
-#include "base/json/json_reader.h"
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace brave_shields {
 
-using ::testing::_;
-
-class CosmeticResourceMergeTest : public testing::Test {
- public:
-  CosmeticResourceMergeTest() {}
-  ~CosmeticResourceMergeTest() override {}
-
-  void CompareMergeFromStrings(
-          const std::string& a,
-          const std::string& b,
-          bool force_hide,
-          const std::string& expected) {
-    base::Optional<base::Value> a_val = base::JSONReader::Read(a);
-    ASSERT_TRUE(a_val);
-
-    base::Optional<base::Value> b_val = base::JSONReader::Read(b);
-    ASSERT_TRUE(b_val);
-
-    const base::Optional<base::Value> expected_val =
-        base::JSONReader::Read(expected);
-    ASSERT_TRUE(expected_val);
-
-    MergeResourcesInto(std::move(b_val.value()), &*a_val, force_hide);
-
-    ASSERT_EQ(*a_val, *expected_val);
-  }
-
- protected:
-  void SetUp() override {}
-
-  void TearDown() override {}
-};
-
-const char EMPTY_RESOURCES[] = "{"
-    "\"hide_selectors\": [], "
-    "\"style_selectors\": {}, "
-    "\"exceptions\": [], "
-    "\"injected_script\": \"\", "
-    "\"generichide\": false"
-"}";
-
-const char NONEMPTY_RESOURCES[] = "{"
-    "\"hide_selectors\": [\"a\", \"b\"], "
-    "\"style_selectors\": {"
-        "\"c\": [\"color: #fff\"], "
-        "\"d\": [\"color: #000\"]"
-    "}, "
-    "\"exceptions\": [\"e\", \"f\"], "
-    "\"injected_script\": \"console.log('g')\", "
-    "\"generichide\": false"
-"}";
-
-TEST_F(CosmeticResourceMergeTest, MergeTwoEmptyResources) {
-  const std::string a = EMPTY_RESOURCES;
-  const std::string b = EMPTY_RESOURCES;
-
-  // Same as EMPTY_RESOURCES, but with an additional newline in the
-  // injected_script
-  const std::string expected = "{"
-      "\"hide_selectors\": [], "
-      "\"style_selectors\": {}, "
-      "\"exceptions\": [], "
-      "\"injected_script\": \"\n\", "
-      "\"generichide\": false"
-  "}";
-
-  CompareMergeFromStrings(a, b, false, expected);
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+namespace {
+
+CosmeticResources MakeEmptyResources() {
+  return CosmeticResources();
+}
+
+CosmeticResources MakeNonEmptyResources() {
+  CosmeticResources resources;
+  resources.hide_selectors = {"a", "b"};
+  resources.style_selectors["c"] = {"color: #fff"};
+  resources.style_selectors["d"] = {"color: #000"};
+  resources.exceptions = {"e", "f"};
+  resources.injected_script = "console.log('g')";
+  return resources;
+}
+
+CosmeticResources MakeOtherNonEmptyResources() {
+  CosmeticResources resources;
+  resources.hide_selectors = {"h", "i"};
+  resources.style_selectors["j"] = {"color: #eee"};
+  resources.style_selectors["k"] = {"color: #111"};
+  resources.exceptions = {"l", "m"};
+  resources.injected_script = "console.log('n')";
+  return resources;
+}
+
+}  // namespace
+
+TEST(CosmeticResourceMergeTest, MergeTwoEmptyResources) {
+  CosmeticResources a = MakeEmptyResources();
+  MergeResourcesInto(MakeEmptyResources(), &a, false);
+
+  EXPECT_THAT(a.hide_selectors, IsEmpty());
+  EXPECT_THAT(a.style_selectors, IsEmpty());
+  EXPECT_THAT(a.exceptions, IsEmpty());
+  // No newline is added for an empty injected_script
+  EXPECT_EQ("", a.injected_script);
+  EXPECT_FALSE(a.generichide);
+  EXPECT_THAT(a.force_hide_selectors, IsEmpty());
 }
 
-TEST_F(CosmeticResourceMergeTest, MergeEmptyIntoNonEmpty) {
-  const std::string a = NONEMPTY_RESOURCES;
-  const std::string b = EMPTY_RESOURCES;
-
-  // Same as a, but with an additional newline at the end of the
-  // injected_script
-  const std::string expected = "{"
-      "\"hide_selectors\": [\"a\", \"b\"], "
-      "\"style_selectors\": {"
-          "\"c\": [\"color: #fff\"], "
-          "\"d\": [\"color: #000\"]"
-      "}, "
-      "\"exceptions\": [\"e\", \"f\"], "
-      "\"injected_script\": \"console.log('g')\n\", "
-      "\"generichide\": false"
-  "}";
-
-  CompareMergeFromStrings(a, b, false, expected);
+TEST(CosmeticResourceMergeTest, MergeEmptyIntoNonEmpty) {
+  CosmeticResources a = MakeNonEmptyResources();
+  MergeResourcesInto(MakeEmptyResources(), &a, false);
+
+  EXPECT_THAT(a.hide_selectors, ElementsAre("a", "b"));
+  EXPECT_THAT(a.style_selectors,
+              ElementsAre(Pair("c", ElementsAre("color: #fff")),
+                          Pair("d", ElementsAre("color: #000"))));
+  EXPECT_THAT(a.exceptions, ElementsAre("e", "f"));
+  // No newline is added for an empty injected_script
+  EXPECT_EQ("console.log('g')", a.injected_script);
+  EXPECT_FALSE(a.generichide);
 }
 
-TEST_F(CosmeticResourceMergeTest, MergeNonEmptyIntoEmpty) {
-  const std::string a = EMPTY_RESOURCES;
-  const std::string b = NONEMPTY_RESOURCES;
-
-  // Same as b, but with an additional newline at the beginning of the
-  // injected_script
-  const std::string expected = "{"
-      "\"hide_selectors\": [\"a\", \"b\"],"
-      "\"style_selectors\": {"
-          "\"c\": [\"color: #fff\"], "
-          "\"d\": [\"color: #000\"]"
-      "}, "
-      "\"exceptions\": [\"e\", \"f\"], "
-      "\"injected_script\": \"\nconsole.log('g')\", "
-      "\"generichide\": false"
-  "}";
-
-  CompareMergeFromStrings(a, b, false, expected);
+TEST(CosmeticResourceMergeTest, MergeNonEmptyIntoEmpty) {
+  CosmeticResources a = MakeEmptyResources();
+  MergeResourcesInto(MakeNonEmptyResources(), &a, false);
+
+  EXPECT_THAT(a.hide_selectors, ElementsAre("a", "b"));
+  EXPECT_THAT(a.style_selectors,
+              ElementsAre(Pair("c", ElementsAre("color: #fff")),
+                          Pair("d", ElementsAre("color: #000"))));
+  EXPECT_THAT(a.exceptions, ElementsAre("e", "f"));
+  // An additional newline at the beginning of the injected_script
+  EXPECT_EQ("\nconsole.log('g')", a.injected_script);
+  EXPECT_FALSE(a.generichide);
 }
 
-TEST_F(CosmeticResourceMergeTest, MergeNonEmptyIntoNonEmpty) {
-  const std::string a = NONEMPTY_RESOURCES;
-  const std::string b = "{"
-      "\"hide_selectors\": [\"h\", \"i\"], "
-      "\"style_selectors\": {"
-          "\"j\": [\"color: #eee\"], "
-          "\"k\": [\"color: #111\"]"
-      "}, "
-      "\"exceptions\": [\"l\", \"m\"], "
-      "\"injected_script\": \"console.log('n')\", "
-      "\"generichide\": false"
-  "}";
-
-  const std::string expected = "{"
-      "\"hide_selectors\": [\"a\", \"b\", \"h\", \"i\"], "
-      "\"style_selectors\": {"
-          "\"c\": [\"color: #fff\"], "
-          "\"d\": [\"color: #000\"], "
-          "\"j\": [\"color: #eee\"], "
-          "\"k\": [\"color: #111\"]"
-      "}, "
-      "\"exceptions\": [\"e\", \"f\", \"l\", \"m\"], "
-      "\"injected_script\": \"console.log('g')\nconsole.log('n')\", "
-      "\"generichide\": false"
-  "}";
-
-  CompareMergeFromStrings(a, b, false, expected);
+TEST(CosmeticResourceMergeTest, MergeNonEmptyIntoNonEmpty) {
+  CosmeticResources a = MakeNonEmptyResources();
+  MergeResourcesInto(MakeOtherNonEmptyResources(), &a, false);
+
+  EXPECT_THAT(a.hide_selectors, ElementsAre("a", "b", "h", "i"));
+  EXPECT_THAT(a.style_selectors,
+              ElementsAre(Pair("c", ElementsAre("color: #fff")),
+                          Pair("d", ElementsAre("color: #000")),
+                          Pair("j", ElementsAre("color: #eee")),
+                          Pair("k", ElementsAre("color: #111"))));
+  EXPECT_THAT(a.exceptions, ElementsAre("e", "f", "l", "m"));
+  EXPECT_EQ("console.log('g')\nconsole.log('n')", a.injected_script);
+  EXPECT_FALSE(a.generichide);
+  EXPECT_THAT(a.force_hide_selectors, IsEmpty());
 }
 
-TEST_F(CosmeticResourceMergeTest, MergeEmptyForceHide) {
-  const std::string a = EMPTY_RESOURCES;
-  const std::string b = EMPTY_RESOURCES;
-
-  // Same as EMPTY_RESOURCES, but with an additional newline in the
-  // injected_script and a new empty `force_hide_selectors` array
-  const std::string expected = "{"
-      "\"hide_selectors\": [], "
-      "\"style_selectors\": {}, "
-      "\"exceptions\": [], "
-      "\"injected_script\": \"\n\","
-      "\"generichide\": false, "
-      "\"force_hide_selectors\": []"
-  "}";
-
-  CompareMergeFromStrings(a, b, true, expected);
+TEST(CosmeticResourceMergeTest, MergeEmptyForceHide) {
+  CosmeticResources a = MakeEmptyResources();
+  MergeResourcesInto(MakeEmptyResources(), &a, true);
+
+  EXPECT_THAT(a.hide_selectors, IsEmpty());
+  EXPECT_THAT(a.style_selectors, IsEmpty());
+  EXPECT_THAT(a.exceptions, IsEmpty());
+  EXPECT_EQ("", a.injected_script);
+  EXPECT_FALSE(a.generichide);
+  EXPECT_THAT(a.force_hide_selectors, IsEmpty());
 }
 
-TEST_F(CosmeticResourceMergeTest, MergeNonEmptyForceHide) {
-  const std::string a = NONEMPTY_RESOURCES;
-  const std::string b = "{"
-      "\"hide_selectors\": [\"h\", \"i\"], "
-      "\"style_selectors\": {"
-          "\"j\": [\"color: #eee\"], "
-          "\"k\": [\"color: #111\"]"
-      "}, "
-      "\"exceptions\": [\"l\", \"m\"], "
-      "\"injected_script\": \"console.log('n')\", "
-      "\"generichide\": false"
-  "}";
-
-  const std::string expected = "{"
-      "\"hide_selectors\": [\"a\", \"b\"], "
-      "\"style_selectors\": {"
-          "\"c\": [\"color: #fff\"], "
-          "\"d\": [\"color: #000\"], "
-          "\"j\": [\"color: #eee\"], "
-          "\"k\": [\"color: #111\"]"
-      "}, "
-      "\"exceptions\": [\"e\", \"f\", \"l\", \"m\"], "
-      "\"injected_script\": \"console.log('g')\nconsole.log('n')\","
-      "\"generichide\": false, "
-      "\"force_hide_selectors\": [\"h\", \"i\"]"
-  "}";
-
-  CompareMergeFromStrings(a, b, true, expected);
+TEST(CosmeticResourceMergeTest, MergeNonEmptyForceHide) {
+  CosmeticResources a = MakeNonEmptyResources();
+  MergeResourcesInto(MakeOtherNonEmptyResources(), &a, true);
+
+  EXPECT_THAT(a.hide_selectors, ElementsAre("a", "b"));
+  EXPECT_THAT(a.style_selectors,
+              ElementsAre(Pair("c", ElementsAre("color: #fff")),
+                          Pair("d", ElementsAre("color: #000")),
+                          Pair("j", ElementsAre("color: #eee")),
+                          Pair("k", ElementsAre("color: #111"))));
+  EXPECT_THAT(a.exceptions, ElementsAre("e", "f", "l", "m"));
+  EXPECT_EQ("console.log('g')\nconsole.log('n')", a.injected_script);
+  EXPECT_FALSE(a.generichide);
+  EXPECT_THAT(a.force_hide_selectors, ElementsAre("h", "i"));
 }
 
-TEST_F(CosmeticResourceMergeTest, MergeNonGenerichideIntoGenerichide) {
-  const std::string a = "{"
-      "\"hide_selectors\": [], "
-      "\"style_selectors\": {}, "
-      "\"exceptions\": [], "
-      "\"injected_script\": \"\n\", "
-      "\"generichide\": true"
-  "}";
-  const std::string b = EMPTY_RESOURCES;
-
-  const std::string expected = "{"
-      "\"hide_selectors\": [], "
-      "\"style_selectors\": {}, "
-      "\"exceptions\": [], "
-      "\"injected_script\": \"\n\n\", "
-      "\"generichide\": true"
-  "}";
-
-  CompareMergeFromStrings(a, b, false, expected);
+TEST(CosmeticResourceMergeTest, MergeNonGenerichideIntoGenerichide) {
+  CosmeticResources a = MakeEmptyResources();
+  a.injected_script = "\n";
+  a.generichide = true;
+  MergeResourcesInto(MakeEmptyResources(), &a, false);
+
+  EXPECT_EQ("\n", a.injected_script);
+  EXPECT_TRUE(a.generichide);
 }
 
-TEST_F(CosmeticResourceMergeTest, MergeGenerichideIntoNonGenerichide) {
-  const std::string a = NONEMPTY_RESOURCES;
-  const std::string b = "{"
-      "\"hide_selectors\": [\"h\", \"i\"], "
-      "\"style_selectors\": {"
-          "\"j\": [\"color: #eee\"], "
-          "\"k\": [\"color: #111\"]"
-      "}, "
-      "\"exceptions\": [\"l\", \"m\"], "
-      "\"injected_script\": \"console.log('n')\", "
-      "\"generichide\": true"
-  "}";
-
-  const std::string expected = "{"
-      "\"hide_selectors\": [\"a\", \"b\", \"h\", \"i\"], "
-      "\"style_selectors\": {"
-          "\"c\": [\"color: #fff\"], "
-          "\"d\": [\"color: #000\"], "
-          "\"j\": [\"color: #eee\"], "
-          "\"k\": [\"color: #111\"]"
-      "}, "
-      "\"exceptions\": [\"e\", \"f\", \"l\", \"m\"], "
-      "\"injected_script\": \"console.log('g')\nconsole.log('n')\", "
-      "\"generichide\": true"
-  "}";
-
-  CompareMergeFromStrings(a, b, false, expected);
+TEST(CosmeticResourceMergeTest, MergeGenerichideIntoNonGenerichide) {
+  CosmeticResources a = MakeNonEmptyResources();
+  CosmeticResources b = MakeOtherNonEmptyResources();
+  b.generichide = true;
+  MergeResourcesInto(std::move(b), &a, false);
+
+  EXPECT_THAT(a.hide_selectors, ElementsAre("a", "b", "h", "i"));
+  EXPECT_THAT(a.exceptions, ElementsAre("e", "f", "l", "m"));
+  EXPECT_EQ("console.log('g')\nconsole.log('n')", a.injected_script);
+  EXPECT_TRUE(a.generichide);
 }
 
-TEST_F(CosmeticResourceMergeTest, MergeGenerichideIntoGenerichide) {
-  const std::string a = "{"
-      "\"hide_selectors\": [], "
-      "\"style_selectors\": {}, "
-      "\"exceptions\": [], "
-      "\"injected_script\": \"\", "
-      "\"generichide\": true"
-  "}";
-
-  const std::string expected = "{"
-      "\"hide_selectors\": [], "
-      "\"style_selectors\": {}, "
-      "\"exceptions\": [], "
-      "\"injected_script\": \"\n\", "
-      "\"generichide\": true"
-  "}";
-
-  CompareMergeFromStrings(a, a, false, expected);
+TEST(CosmeticResourceMergeTest, MergeGenerichideIntoGenerichide) {
+  CosmeticResources a = MakeEmptyResources();
+  a.generichide = true;
+  CosmeticResources b = MakeEmptyResources();
+  b.generichide = true;
+  MergeResourcesInto(std::move(b), &a, false);
+
+  EXPECT_EQ("", a.injected_script);
+  EXPECT_TRUE(a.generichide);
 }
 
-TEST_F(CosmeticResourceMergeTest, MergeStyles) {
-  const std::string a = "{"
-      "\"hide_selectors\": [], "
-      "\"style_selectors\": {"
-          "\".a\": [\"color: #eee\"], "
-          "\".b\": [\"color: #111\"], "
-          "\".d\": [\"padding: 0\"]"
-      "}, "
-      "\"exceptions\": [], "
-      "\"injected_script\": \"\", "
-      "\"generichide\": false"
-  "}";
-  const std::string b = "{"
-      "\"hide_selectors\": [], "
-      "\"style_selectors\": {"
-          "\".c\": [\"margin: 0\"], "
-          "\".b\": [\"background: #000\"], "
-          "\".a\": [\"background: #fff\"]"
-      "}, "
-      "\"exceptions\": [], "
-      "\"injected_script\": \"\", "
-      "\"generichide\": false"
-  "}";
-
-  const std::string expected = "{"
-      "\"hide_selectors\": [], "
-      "\"style_selectors\": {"
-          "\".a\": [\"color: #eee\", \"background: #fff\"], "
-          "\".b\": [\"color: #111\", \"background: #000\"], "
-          "\".c\": [\"margin: 0\"], "
-          "\".d\": [\"padding: 0\"] "
-      "}, "
-      "\"exceptions\": [], "
-      "\"injected_script\": \"\n\", "
-      "\"generichide\": false"
-  "}";
-
-  CompareMergeFromStrings(a, b, false, expected);
+TEST(CosmeticResourceMergeTest, MergeStyles) {
+  CosmeticResources a = MakeEmptyResources();
+  a.style_selectors[".a"] = {"color: #eee"};
+  a.style_selectors[".b"] = {"color: #111"};
+  a.style_selectors[".d"] = {"padding: 0"};
+  CosmeticResources b = MakeEmptyResources();
+  b.style_selectors[".c"] = {"margin: 0"};
+  b.style_selectors[".b"] = {"background: #000"};
+  b.style_selectors[".a"] = {"background: #fff"};
+  b.style_selectors[".e"] = {};
+  MergeResourcesInto(std::move(b), &a, false);
+
+  EXPECT_THAT(
+      a.style_selectors,
+      ElementsAre(Pair(".a", ElementsAre("color: #eee", "background: #fff")),
+                  Pair(".b", ElementsAre("color: #111", "background: #000")),
+                  Pair(".c", ElementsAre("margin: 0")),
+                  Pair(".d", ElementsAre("padding: 0")),
+                  Pair(".e", IsEmpty())));
+  EXPECT_EQ("", a.injected_script);
 }
 
+TEST(CosmeticResourceMergeTest, FromEngineResources) {
+  adblock::UrlCosmeticResources engine_resources;
+  engine_resources.hide_selectors = {"a"};
+  engine_resources.style_selectors["b"] = {"color: #fff"};
+  engine_resources.exceptions = {"c"};
+  engine_resources.injected_script = "console.log('d')";
+  engine_resources.generichide = true;
+
+  CosmeticResources resources(std::move(engine_resources));
+  EXPECT_THAT(resources.hide_selectors, ElementsAre("a"));
+  EXPECT_THAT(resources.style_selectors,
+              ElementsAre(Pair("b", ElementsAre("color: #fff"))));
+  EXPECT_THAT(resources.exceptions, ElementsAre("c"));
+  EXPECT_EQ("console.log('d')", resources.injected_script);
+  EXPECT_TRUE(resources.generichide);
+  EXPECT_THAT(resources.force_hide_selectors, IsEmpty());
+}
 
 }  // namespace brave_shields
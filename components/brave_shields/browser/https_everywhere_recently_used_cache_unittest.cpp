@@ -28,3 +28,41 @@ TEST(HTTPSEverywhereRecentlyUsedCacheTest, Operations) {
   cache.remove("kD");
   ASSERT_FALSE(cache.get("kD", &v));
 }
+
+TEST(HTTPSEverywhereRecentlyUsedCacheTest, Sharded) {
+  using Cache = HTTPSERecentlyUsedCache<std::string>;
+  Cache cache(64, 8);
+
+  for (int i = 0; i < 16; ++i)
+    cache.add("k" + std::to_string(i), "v" + std::to_string(i));
+  std::string v;
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_TRUE(cache.get("k" + std::to_string(i), &v));
+    ASSERT_EQ(v, "v" + std::to_string(i));
+  }
+
+  cache.clear();
+  for (int i = 0; i < 16; ++i)
+    ASSERT_FALSE(cache.get("k" + std::to_string(i), &v));
+}
+
+TEST(HTTPSEverywhereRecentlyUsedCacheTest, Stats) {
+  using Cache = HTTPSERecentlyUsedCache<bool>;
+  Cache cache(10, 2);
+
+  bool v = false;
+  cache.add("example.com", true);
+  ASSERT_TRUE(cache.get("example.com", &v));
+  ASSERT_TRUE(v);
+  ASSERT_FALSE(cache.get("brave.com", &v));
+  ASSERT_FALSE(cache.get("brave.com", &v));
+
+  Cache::Stats stats = cache.TakeStats();
+  ASSERT_EQ(stats.hits, 1u);
+  ASSERT_EQ(stats.misses, 2u);
+
+  // Taking the stats resets them.
+  stats = cache.TakeStats();
+  ASSERT_EQ(stats.hits, 0u);
+  ASSERT_EQ(stats.misses, 0u);
+}
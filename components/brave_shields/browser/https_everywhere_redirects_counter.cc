@@ -0,0 +1,66 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_redirects_counter.h"
+
+#include "base/check_op.h"
+
+namespace brave_shields {
+
+namespace {
+
+constexpr uint64_t kCountMask = HTTPSERedirectsCounter::kMaxCount;
+
+uint64_t PackedKey(uint64_t request_identifier) {
+  return request_identifier << HTTPSERedirectsCounter::kCountBits;
+}
+
+}  // namespace
+
+HTTPSERedirectsCounter::HTTPSERedirectsCounter(size_t slots_count)
+    : slots_count_(slots_count),
+      slots_(new std::atomic<uint64_t>[slots_count]) {
+  DCHECK_GT(slots_count_, 0u);
+  for (size_t i = 0; i < slots_count_; ++i)
+    slots_[i].store(0, std::memory_order_relaxed);
+}
+
+HTTPSERedirectsCounter::~HTTPSERedirectsCounter() = default;
+
+std::atomic<uint64_t>& HTTPSERedirectsCounter::GetSlot(
+    uint64_t request_identifier) const {
+  return slots_[request_identifier % slots_count_];
+}
+
+unsigned int HTTPSERedirectsCounter::GetCount(
+    uint64_t request_identifier) const {
+  const uint64_t value =
+      GetSlot(request_identifier).load(std::memory_order_acquire);
+  if ((value & ~kCountMask) != PackedKey(request_identifier))
+    return 0;
+  return value & kCountMask;
+}
+
+void HTTPSERedirectsCounter::Increment(uint64_t request_identifier) {
+  std::atomic<uint64_t>& slot = GetSlot(request_identifier);
+  const uint64_t key = PackedKey(request_identifier);
+  uint64_t value = slot.load(std::memory_order_relaxed);
+  uint64_t new_value;
+  do {
+    if ((value & ~kCountMask) != key) {
+      // The slot belongs to an older request, take it over.
+      new_value = key | 1;
+    } else if ((value & kCountMask) == kCountMask) {
+      // Saturated, nothing to record.
+      return;
+    } else {
+      new_value = value + 1;
+    }
+  } while (!slot.compare_exchange_weak(value, new_value,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_relaxed));
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,55 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_REDIRECTS_COUNTER_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_REDIRECTS_COUNTER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+#include "base/macros.h"
+
+namespace brave_shields {
+
+// Counts how many times each request has been upgraded by HTTPS Everywhere,
+// to break redirect loops. Entries live in a fixed size table indexed by
+// request identifier, so lookups and inserts are O(1) and lock free. Request
+// identifiers are handed out sequentially, which makes the table behave like
+// a ring: a new request evicts the one |slots_count| requests older.
+class HTTPSERedirectsCounter {
+ public:
+  // Number of low bits of a slot which hold the redirects count.
+  static constexpr unsigned int kCountBits = 4;
+  // Counts saturate at this value, so callers must not need to tell larger
+  // counts apart.
+  static constexpr unsigned int kMaxCount = (1u << kCountBits) - 1;
+
+  explicit HTTPSERedirectsCounter(size_t slots_count);
+  ~HTTPSERedirectsCounter();
+
+  // Returns the number of redirects recorded for |request_identifier|, at most
+  // |kMaxCount|.
+  unsigned int GetCount(uint64_t request_identifier) const;
+
+  // Records one more redirect for |request_identifier|, unless its count is
+  // already |kMaxCount|.
+  void Increment(uint64_t request_identifier);
+
+ private:
+  std::atomic<uint64_t>& GetSlot(uint64_t request_identifier) const;
+
+  const size_t slots_count_;
+  // Each slot packs the request identifier in the high bits and the
+  // redirects count in the low |kCountBits| bits.
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSERedirectsCounter);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_REDIRECTS_COUNTER_H_
@@ -0,0 +1,92 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+#include <vector>
+
+#include "base/threading/simple_thread.h"
+#include "brave/components/brave_shields/browser/https_everywhere_redirects_counter.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_shields {
+
+namespace {
+
+class IncrementDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  IncrementDelegate(HTTPSERedirectsCounter* counter,
+                    uint64_t first_request_identifier,
+                    uint64_t requests_count)
+      : counter_(counter),
+        first_request_identifier_(first_request_identifier),
+        requests_count_(requests_count) {}
+
+  void Run() override {
+    for (int i = 0; i < 3; ++i) {
+      for (uint64_t id = first_request_identifier_;
+           id < first_request_identifier_ + requests_count_; ++id) {
+        counter_->Increment(id);
+      }
+    }
+  }
+
+ private:
+  HTTPSERedirectsCounter* counter_;
+  uint64_t first_request_identifier_;
+  uint64_t requests_count_;
+};
+
+}  // namespace
+
+TEST(HTTPSEverywhereRedirectsCounterTest, CountsPerRequest) {
+  HTTPSERedirectsCounter counter(16);
+  EXPECT_EQ(0u, counter.GetCount(1));
+
+  counter.Increment(1);
+  counter.Increment(1);
+  counter.Increment(2);
+  EXPECT_EQ(2u, counter.GetCount(1));
+  EXPECT_EQ(1u, counter.GetCount(2));
+  EXPECT_EQ(0u, counter.GetCount(3));
+}
+
+TEST(HTTPSEverywhereRedirectsCounterTest, EvictsOldestRequests) {
+  HTTPSERedirectsCounter counter(16);
+  counter.Increment(1);
+  // Request 17 shares the slot of request 1 and takes it over.
+  counter.Increment(17);
+  EXPECT_EQ(0u, counter.GetCount(1));
+  EXPECT_EQ(1u, counter.GetCount(17));
+}
+
+TEST(HTTPSEverywhereRedirectsCounterTest, Saturates) {
+  HTTPSERedirectsCounter counter(1);
+  for (int i = 0; i < 100; ++i)
+    counter.Increment(5);
+  EXPECT_EQ(15u, counter.GetCount(5));
+}
+
+TEST(HTTPSEverywhereRedirectsCounterTest, ConcurrentRequests) {
+  constexpr uint64_t kThreadsCount = 8;
+  constexpr uint64_t kRequestsPerThread = 512;
+  HTTPSERedirectsCounter counter(kThreadsCount * kRequestsPerThread);
+
+  std::vector<std::unique_ptr<IncrementDelegate>> delegates;
+  std::vector<std::unique_ptr<base::DelegateSimpleThread>> threads;
+  for (uint64_t i = 0; i < kThreadsCount; ++i) {
+    delegates.push_back(std::make_unique<IncrementDelegate>(
+        &counter, 1 + i * kRequestsPerThread, kRequestsPerThread));
+    threads.push_back(std::make_unique<base::DelegateSimpleThread>(
+        delegates.back().get(), "HTTPSERedirectsCounterTest"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Join();
+
+  for (uint64_t id = 1; id <= kThreadsCount * kRequestsPerThread; ++id)
+    EXPECT_EQ(3u, counter.GetCount(id));
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,172 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/json/json_reader.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/values.h"
+#include "third_party/re2/src/re2/re2.h"
+#include "third_party/re2/src/re2/set.h"
+
+namespace brave_shields {
+
+// One entry of the top level rules list: a set of exclusions and an ordered
+// list of rewrites.
+class HTTPSERuleset::RuleGroup {
+ public:
+  RuleGroup() = default;
+  ~RuleGroup() = default;
+
+  bool AddExclusion(const std::string& pattern) {
+    auto regex = std::make_unique<re2::RE2>(pattern);
+    if (!regex->ok())
+      return false;
+    if (!exclusion_set_) {
+      exclusion_set_ = std::make_unique<re2::RE2::Set>(
+          re2::RE2::DefaultOptions, re2::RE2::ANCHOR_BOTH);
+    }
+    if (exclusion_set_->Add(pattern, nullptr) < 0)
+      return false;
+    exclusions_.push_back(std::move(regex));
+    return true;
+  }
+
+  void AddDefaultRewrite() { rewrites_.emplace_back(nullptr, std::string()); }
+
+  void AddRewrite(const std::string& from, const std::string& to) {
+    auto regex = std::make_unique<re2::RE2>(from);
+    // A pattern that does not compile can never rewrite anything.
+    if (!regex->ok())
+      return;
+    rewrites_.emplace_back(std::move(regex), to);
+  }
+
+  void Compile() {
+    if (!exclusion_set_)
+      return;
+    if (exclusion_set_->Compile()) {
+      // The individual regexes are only needed as a fallback.
+      exclusions_.clear();
+    } else {
+      LOG(ERROR) << "Failed to compile HTTPSE exclusion set";
+      exclusion_set_.reset();
+    }
+  }
+
+  bool IsExcluded(const std::string& url) const {
+    if (exclusion_set_)
+      return exclusion_set_->Match(url, nullptr);
+    return std::any_of(exclusions_.begin(), exclusions_.end(),
+                       [&url](const std::unique_ptr<re2::RE2>& regex) {
+                         return re2::RE2::FullMatch(url, *regex);
+                       });
+  }
+
+  bool Rewrite(const std::string& url, std::string* new_url) const {
+    for (const auto& rewrite : rewrites_) {
+      if (!rewrite.first) {
+        *new_url = url;
+        new_url->insert(4, "s");
+        return true;
+      }
+      std::string candidate(url);
+      if (re2::RE2::Replace(&candidate, *rewrite.first, rewrite.second) &&
+          candidate != url) {
+        *new_url = std::move(candidate);
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::unique_ptr<re2::RE2::Set> exclusion_set_;
+  std::vector<std::unique_ptr<re2::RE2>> exclusions_;
+  // A null regex marks a default rule, which upgrades the scheme as is.
+  std::vector<std::pair<std::unique_ptr<re2::RE2>, std::string>> rewrites_;
+
+  DISALLOW_COPY_AND_ASSIGN(RuleGroup);
+};
+
+HTTPSERuleset::HTTPSERuleset() = default;
+
+HTTPSERuleset::~HTTPSERuleset() = default;
+
+// static
+std::unique_ptr<HTTPSERuleset> HTTPSERuleset::Parse(const std::string& json) {
+  base::Optional<base::Value> json_object = base::JSONReader::Read(json);
+  if (!json_object || !json_object->is_list())
+    return nullptr;
+
+  auto ruleset = base::WrapUnique(new HTTPSERuleset());
+  for (const auto& top_value : json_object->GetList()) {
+    if (!top_value.is_dict())
+      continue;
+
+    auto group = std::make_unique<RuleGroup>();
+    const base::Value* exclusions = top_value.FindListKey("e");
+    if (exclusions) {
+      for (const auto& exclusion : exclusions->GetList()) {
+        if (!exclusion.is_dict())
+          continue;
+        const std::string* pattern = exclusion.FindStringKey("p");
+        if (pattern)
+          group->AddExclusion(CorrectToRuleForRE2(*pattern));
+      }
+    }
+    group->Compile();
+
+    // A group without rewrites stops the lookup once its exclusions have
+    // been checked, so nothing after it is reachable.
+    const base::Value* rules = top_value.FindListKey("r");
+    if (!rules) {
+      ruleset->groups_.push_back(std::move(group));
+      break;
+    }
+
+    for (const auto& rule : rules->GetList()) {
+      if (!rule.is_dict())
+        continue;
+      if (rule.FindKey("d")) {
+        group->AddDefaultRewrite();
+        // Nothing after a default rule can be reached.
+        break;
+      }
+      const std::string* from = rule.FindStringKey("f");
+      const std::string* to = rule.FindStringKey("t");
+      if (!from || !to)
+        continue;
+      group->AddRewrite(*from, CorrectToRuleForRE2(*to));
+    }
+    ruleset->groups_.push_back(std::move(group));
+  }
+
+  return ruleset;
+}
+
+// static
+std::string HTTPSERuleset::CorrectToRuleForRE2(const std::string& to) {
+  std::string corrected(to);
+  std::replace(corrected.begin(), corrected.end(), '$', '\\');
+  return corrected;
+}
+
+std::string HTTPSERuleset::Apply(const std::string& url) const {
+  std::string new_url;
+  for (const auto& group : groups_) {
+    if (group->IsExcluded(url))
+      return std::string();
+    if (group->Rewrite(url, &new_url))
+      return new_url;
+  }
+  return std::string();
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,50 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+
+namespace re2 {
+class RE2;
+}  // namespace re2
+
+namespace brave_shields {
+
+// A single HTTPS Everywhere ruleset (the JSON value stored in the leveldb
+// for one lookup domain) with its exclusion and rewrite patterns compiled up
+// front, so that applying it to a URL does not parse JSON or build regexes.
+class HTTPSERuleset {
+ public:
+  ~HTTPSERuleset();
+
+  // Returns nullptr if |json| is not a list of rules.
+  static std::unique_ptr<HTTPSERuleset> Parse(const std::string& json);
+
+  // Converts the "$1" style back-references used by the rules to the "\1"
+  // style expected by RE2.
+  static std::string CorrectToRuleForRE2(const std::string& to);
+
+  // Returns the rewritten URL, or an empty string if no rule applies.
+  std::string Apply(const std::string& url) const;
+
+ private:
+  class RuleGroup;
+
+  HTTPSERuleset();
+
+  std::vector<std::unique_ptr<RuleGroup>> groups_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSERuleset);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
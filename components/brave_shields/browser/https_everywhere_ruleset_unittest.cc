@@ -0,0 +1,103 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+#include <string>
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_shields {
+
+TEST(HTTPSEverywhereRulesetTest, RejectsInvalidJson) {
+  EXPECT_FALSE(HTTPSERuleset::Parse(""));
+  EXPECT_FALSE(HTTPSERuleset::Parse("{}"));
+  EXPECT_TRUE(HTTPSERuleset::Parse("[]"));
+}
+
+TEST(HTTPSEverywhereRulesetTest, CorrectToRuleForRE2) {
+  EXPECT_EQ("https://\\1.example.com/\\2",
+            HTTPSERuleset::CorrectToRuleForRE2("https://$1.example.com/$2"));
+  EXPECT_EQ("https://example.com/",
+            HTTPSERuleset::CorrectToRuleForRE2("https://example.com/"));
+}
+
+TEST(HTTPSEverywhereRulesetTest, DefaultRule) {
+  std::unique_ptr<HTTPSERuleset> ruleset =
+      HTTPSERuleset::Parse(R"([{"r": [{"d": 1}]}])");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ("https://example.com/", ruleset->Apply("http://example.com/"));
+}
+
+TEST(HTTPSEverywhereRulesetTest, RewriteRules) {
+  std::unique_ptr<HTTPSERuleset> ruleset = HTTPSERuleset::Parse(R"([{
+        "r": [
+          {"f": "^http://nomatch\\.com/", "t": "https://nomatch.com/"},
+          {"f": "^http://(www\\.)?example\\.com/",
+           "t": "https://$1example.com/"}
+        ]
+      }])");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ("https://www.example.com/a",
+            ruleset->Apply("http://www.example.com/a"));
+  EXPECT_EQ("https://example.com/b", ruleset->Apply("http://example.com/b"));
+  EXPECT_EQ("", ruleset->Apply("http://other.com/"));
+}
+
+TEST(HTTPSEverywhereRulesetTest, Exclusions) {
+  std::unique_ptr<HTTPSERuleset> ruleset = HTTPSERuleset::Parse(R"([{
+        "e": [
+          {"p": "^http://example\\.com/insecure/.*"},
+          {"p": "^http://example\\.com/other"}
+        ],
+        "r": [{"d": 1}]
+      }])");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ("", ruleset->Apply("http://example.com/insecure/page"));
+  // Exclusions must match the whole URL.
+  EXPECT_EQ("", ruleset->Apply("http://example.com/other"));
+  EXPECT_EQ("https://example.com/other/page",
+            ruleset->Apply("http://example.com/other/page"));
+  EXPECT_EQ("https://example.com/", ruleset->Apply("http://example.com/"));
+}
+
+TEST(HTTPSEverywhereRulesetTest, GroupsAreAppliedInOrder) {
+  std::unique_ptr<HTTPSERuleset> ruleset = HTTPSERuleset::Parse(R"([
+        "ignored",
+        {"r": [{"f": "^http://a\\.com/", "t": "https://a.com/"}]},
+        {"e": [{"p": "^http://b\\.com/x"}],
+         "r": [{"f": "^http://b\\.com/", "t": "https://b.com/"}]},
+        {"r": [{"d": 1}]}
+      ])");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ("https://a.com/", ruleset->Apply("http://a.com/"));
+  EXPECT_EQ("https://b.com/y", ruleset->Apply("http://b.com/y"));
+  // An exclusion in a group stops the lookup altogether.
+  EXPECT_EQ("", ruleset->Apply("http://b.com/x"));
+  EXPECT_EQ("https://c.com/", ruleset->Apply("http://c.com/"));
+}
+
+TEST(HTTPSEverywhereRulesetTest, GroupWithoutRulesStopsLookup) {
+  std::unique_ptr<HTTPSERuleset> ruleset = HTTPSERuleset::Parse(R"([
+        {"e": []},
+        {"r": [{"d": 1}]}
+      ])");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ("", ruleset->Apply("http://example.com/"));
+}
+
+TEST(HTTPSEverywhereRulesetTest, InvalidPatternsAreSkipped) {
+  std::unique_ptr<HTTPSERuleset> ruleset = HTTPSERuleset::Parse(R"([{
+        "e": [{"p": "(unbalanced"}],
+        "r": [
+          {"f": "(unbalanced", "t": "https://bad/"},
+          {"f": "^http:", "t": "https:"}
+        ]
+      }])");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ("https://example.com/", ruleset->Apply("http://example.com/"));
+}
+
+}  // namespace brave_shields
@@ -7,26 +7,34 @@
 
 #include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "base/base_paths.h"
 #include "base/bind.h"
-#include "base/json/json_reader.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/scoped_blocking_call.h"
-#include "base/values.h"
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
 #include "third_party/leveldatabase/src/include/leveldb/db.h"
-#include "third_party/re2/src/re2/re2.h"
+#include "third_party/leveldatabase/src/include/leveldb/iterator.h"
 #include "third_party/zlib/google/zip.h"
 
 #define DAT_FILE "httpse.leveldb.zip"
 #define DAT_FILE_VERSION "6.0"
-#define HTTPSE_URLS_REDIRECTS_COUNT_QUEUE   1
+#define HTTPSE_URLS_REDIRECTS_COUNT_QUEUE   1024
 #define HTTPSE_URL_MAX_REDIRECTS_COUNT      5
+#define HTTPSE_RECENTLY_USED_CACHE_SIZE     1000
+#define HTTPSE_HOSTS_WITHOUT_RULES_CACHE_SIZE 4000
+#define HTTPSE_CACHE_SHARDS_COUNT           16
+
+static_assert(HTTPSE_URL_MAX_REDIRECTS_COUNT <=
+                  brave_shields::HTTPSERedirectsCounter::kMaxCount,
+              "Redirect counts saturate before the maximum is reached");
 
 namespace {
 
@@ -65,15 +73,6 @@ std::vector<std::string> ExpandDomainForLookup(const std::string& domain) {
   }
   return resultDomains;
 }
-std::string leveldbGet(leveldb::DB* db, const std::string &key) {
-  if (!db) {
-    return "";
-  }
-
-  std::string value;
-  leveldb::Status s = db->Get(leveldb::ReadOptions(), key, &value);
-  return s.ok() ? value : "";
-}
 
 }  // namespace
 
@@ -100,12 +99,20 @@ HTTPSEverywhereService::g_https_everywhere_component_base64_public_key_(
 HTTPSEverywhereService::HTTPSEverywhereService(
     BraveComponent::Delegate* delegate)
     : BaseBraveShieldsService(delegate),
-      level_db_(nullptr) {
+      redirects_counter_(HTTPSE_URLS_REDIRECTS_COUNT_QUEUE),
+      recently_used_cache_(HTTPSE_RECENTLY_USED_CACHE_SIZE,
+                           HTTPSE_CACHE_SHARDS_COUNT),
+      hosts_without_rules_cache_(HTTPSE_HOSTS_WITHOUT_RULES_CACHE_SIZE,
+                                 HTTPSE_CACHE_SHARDS_COUNT) {
   DETACH_FROM_SEQUENCE(sequence_checker_);
 }
 
+HTTPSEverywhereService::Rulesets::Rulesets() = default;
+
+HTTPSEverywhereService::Rulesets::~Rulesets() = default;
+
 HTTPSEverywhereService::~HTTPSEverywhereService() {
-  GetTaskRunner()->DeleteSoon(FROM_HERE, level_db_);
+  GetTaskRunner()->DeleteSoon(FROM_HERE, rulesets_.release());
 }
 
 bool HTTPSEverywhereService::Init() {
@@ -127,20 +134,55 @@ void HTTPSEverywhereService::InitDB(const base::FilePath& install_dir) {
     return;
   }
 
-  CloseDatabase();
-
+  leveldb::DB* level_db = nullptr;
   leveldb::Options options;
   leveldb::Status status =
       leveldb::DB::Open(options,
                         unzipped_level_db_path.AsUTF8Unsafe(),
-                        &level_db_);
-  if (!status.ok() || !level_db_) {
+                        &level_db);
+  if (!status.ok() || !level_db) {
     LOG(ERROR) << "Level db open error "
                << unzipped_level_db_path.value().c_str()
                << ", error: " << status.ToString();
-    CloseDatabase();
+    delete level_db;
     return;
   }
+
+  // Compile every ruleset once here so that lookups on the request path never
+  // touch the database, parse JSON or build regexes. Many lookup domains store
+  // the same rules, so each distinct JSON value is only compiled once.
+  auto rulesets = std::make_unique<Rulesets>();
+  std::vector<std::pair<std::string, const HTTPSERuleset*>> by_domain;
+  std::unordered_map<std::string, const HTTPSERuleset*> by_json;
+  std::unique_ptr<leveldb::Iterator> it(
+      level_db->NewIterator(leveldb::ReadOptions()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    std::string json = it->value().ToString();
+    auto json_it = by_json.find(json);
+    if (json_it == by_json.end()) {
+      // Invalid JSON is remembered as well, as nullptr.
+      std::unique_ptr<HTTPSERuleset> compiled = HTTPSERuleset::Parse(json);
+      json_it = by_json.emplace(std::move(json), compiled.get()).first;
+      if (compiled)
+        rulesets->compiled.push_back(std::move(compiled));
+    }
+    if (json_it->second)
+      by_domain.emplace_back(it->key().ToString(), json_it->second);
+  }
+  if (!it->status().ok()) {
+    LOG(ERROR) << "Level db read error "
+               << unzipped_level_db_path.value().c_str()
+               << ", error: " << it->status().ToString();
+  }
+  it.reset();
+  delete level_db;
+
+  rulesets->by_domain =
+      base::flat_map<std::string, const HTTPSERuleset*>(std::move(by_domain));
+  rulesets_ = std::move(rulesets);
+  RecordCacheHitRate();
+  recently_used_cache_.clear();
+  hosts_without_rules_cache_.clear();
 }
 
 void HTTPSEverywhereService::OnComponentReady(
@@ -161,7 +203,7 @@ bool HTTPSEverywhereService::GetHTTPSURL(
   if (!url->is_valid())
     return false;
 
-  if (!IsInitialized() || !level_db_ || url->scheme() == url::kHttpsScheme) {
+  if (!IsInitialized() || !rulesets_ || url->scheme() == url::kHttpsScheme) {
     return false;
   }
   if (!ShouldHTTPSERedirect(request_identifier)) {
@@ -173,6 +215,11 @@ bool HTTPSEverywhereService::GetHTTPSURL(
     return true;
   }
 
+  bool no_rules = false;
+  if (hosts_without_rules_cache_.get(url->host(), &no_rules)) {
+    return false;
+  }
+
   GURL candidate_url(*url);
   if (g_ignore_port_for_test_ && candidate_url.has_port()) {
     GURL::Replacements replacements;
@@ -182,10 +229,12 @@ bool HTTPSEverywhereService::GetHTTPSURL(
 
   const std::vector<std::string> domains =
       ExpandDomainForLookup(candidate_url.host());
-  for (auto domain : domains) {
-    std::string value = leveldbGet(level_db_, domain);
-    if (!value.empty()) {
-      *new_url = ApplyHTTPSRule(candidate_url.spec(), value);
+  bool found_ruleset = false;
+  for (const auto& domain : domains) {
+    auto it = rulesets_->by_domain.find(domain);
+    if (it != rulesets_->by_domain.end()) {
+      found_ruleset = true;
+      *new_url = it->second->Apply(candidate_url.spec());
       if (0 != new_url->length()) {
         recently_used_cache_.add(candidate_url.spec(), *new_url);
         AddHTTPSEUrlToRedirectList(request_identifier);
@@ -194,6 +243,9 @@ bool HTTPSEverywhereService::GetHTTPSURL(
     }
   }
   recently_used_cache_.remove(candidate_url.spec());
+  if (!found_ruleset) {
+    hosts_without_rules_cache_.add(candidate_url.host(), true);
+  }
   return false;
 }
 
@@ -215,169 +267,43 @@ bool HTTPSEverywhereService::GetHTTPSURLFromCacheOnly(
     AddHTTPSEUrlToRedirectList(request_identifier);
     return true;
   }
-  return false;
-}
-
-bool HTTPSEverywhereService::ShouldHTTPSERedirect(
-    const uint64_t& request_identifier) {
-  base::AutoLock auto_lock(httpse_get_urls_redirects_count_mutex_);
-  for (size_t i = 0; i < httpse_urls_redirects_count_.size(); i++) {
-    if (request_identifier ==
-        httpse_urls_redirects_count_[i].request_identifier_ &&
-        httpse_urls_redirects_count_[i].redirects_ >=
-        HTTPSE_URL_MAX_REDIRECTS_COUNT - 1) {
-      return false;
-    }
-  }
-
-  return true;
-}
 
-void HTTPSEverywhereService::AddHTTPSEUrlToRedirectList(
-    const uint64_t& request_identifier) {
-  // Adding redirects count for the current request
-  base::AutoLock auto_lock(httpse_get_urls_redirects_count_mutex_);
-  bool hostFound = false;
-  for (size_t i = 0; i < httpse_urls_redirects_count_.size(); i++) {
-    if (request_identifier ==
-        httpse_urls_redirects_count_[i].request_identifier_) {
-      // Found the host, just increment the redirects_count
-      httpse_urls_redirects_count_[i].redirects_++;
-      hostFound = true;
-      break;
-    }
-  }
-  if (!hostFound) {
-      // The host is new, adding it to the redirects list
-      if (httpse_urls_redirects_count_.size() >=
-          HTTPSE_URLS_REDIRECTS_COUNT_QUEUE) {
-          // The queue is full, erase the first element
-          httpse_urls_redirects_count_.erase(
-              httpse_urls_redirects_count_.begin());
-      }
-      httpse_urls_redirects_count_.push_back(
-          HTTPSE_REDIRECTS_COUNT_ST(request_identifier, 1));
+  bool no_rules = false;
+  if (hosts_without_rules_cache_.get(url->host(), &no_rules)) {
+    cached_url->clear();
+    return true;
   }
+  return false;
 }
 
-std::string HTTPSEverywhereService::ApplyHTTPSRule(
-    const std::string& originalUrl,
-    const std::string& rule) {
-  base::Optional<base::Value> json_object = base::JSONReader::Read(rule);
-  if (base::nullopt == json_object || !json_object->is_list()) {
-    return "";
+void HTTPSEverywhereService::RecordCacheHitRate() {
+  // Reported once per set of rules, right before the caches are reset.
+  const auto recently_used = recently_used_cache_.TakeStats();
+  if (recently_used.hits + recently_used.misses > 0) {
+    UMA_HISTOGRAM_PERCENTAGE(
+        "Brave.HTTPSE.RecentlyUsedCacheHitRate",
+        100 * recently_used.hits /
+            (recently_used.hits + recently_used.misses));
   }
-
-  base::Value::ConstListView topValues = json_object->GetList();
-  for (auto it = topValues.cbegin(); it != topValues.cend(); ++it) {
-    if (!it->is_dict()) {
-      continue;
-    }
-    const base::DictionaryValue* childTopDictionary = nullptr;
-    it->GetAsDictionary(&childTopDictionary);
-    if (nullptr == childTopDictionary) {
-      continue;
-    }
-
-    const base::Value* exclusion = nullptr;
-    if (childTopDictionary->Get("e", &exclusion)) {
-      const base::ListValue* eValues = nullptr;
-      exclusion->GetAsList(&eValues);
-      if (nullptr != eValues) {
-        for (size_t j = 0; j < eValues->GetSize(); ++j) {
-          const base::Value* pValue = nullptr;
-          if (!eValues->Get(j, &pValue)) {
-            continue;
-          }
-          const base::DictionaryValue* pDictionary = nullptr;
-          pValue->GetAsDictionary(&pDictionary);
-          if (nullptr == pDictionary) {
-            continue;
-          }
-          const base::Value* patternValue = nullptr;
-          if (!pDictionary->Get("p", &patternValue)) {
-            continue;
-          }
-          std::string pattern;
-          if (!patternValue->GetAsString(&pattern)) {
-            continue;
-          }
-          pattern = CorrecttoRuleToRE2Engine(pattern);
-          if (RE2::FullMatch(originalUrl, pattern)) {
-            return "";
-          }
-        }
-      }
-    }
-
-    const base::Value* rules = nullptr;
-    if (!childTopDictionary->Get("r", &rules)) {
-      return "";
-    }
-    const base::ListValue* rValues = nullptr;
-    rules->GetAsList(&rValues);
-    if (nullptr == rValues) {
-      return "";
-    }
-
-    for (size_t j = 0; j < rValues->GetSize(); ++j) {
-      const base::Value* pValue = nullptr;
-      if (!rValues->Get(j, &pValue)) {
-        continue;
-      }
-      const base::DictionaryValue* pDictionary = nullptr;
-      pValue->GetAsDictionary(&pDictionary);
-      if (nullptr == pDictionary) {
-        continue;
-      }
-      const base::Value* patternValue = nullptr;
-      if (pDictionary->Get("d", &patternValue)) {
-        std::string newUrl(originalUrl);
-        return newUrl.insert(4, "s");
-      }
-
-      const base::Value* from_value = nullptr;
-      const base::Value* to_value = nullptr;
-      if (!pDictionary->Get("f", &from_value) ||
-          !pDictionary->Get("t", &to_value)) {
-        continue;
-      }
-      std::string from, to;
-      if (!from_value->GetAsString(&from) ||
-          !to_value->GetAsString(&to)) {
-        continue;
-      }
-
-      to = CorrecttoRuleToRE2Engine(to);
-      std::string newUrl(originalUrl);
-      RE2 regExp(from);
-
-      if (RE2::Replace(&newUrl, regExp, to) && newUrl != originalUrl) {
-        return newUrl;
-      }
-    }
+  const auto hosts_without_rules = hosts_without_rules_cache_.TakeStats();
+  if (hosts_without_rules.hits + hosts_without_rules.misses > 0) {
+    UMA_HISTOGRAM_PERCENTAGE(
+        "Brave.HTTPSE.HostsWithoutRulesCacheHitRate",
+        100 * hosts_without_rules.hits /
+            (hosts_without_rules.hits + hosts_without_rules.misses));
   }
-  return "";
 }
 
-std::string HTTPSEverywhereService::CorrecttoRuleToRE2Engine(
-    const std::string& to) {
-  std::string correctedto(to);
-  size_t pos = to.find("$");
-  while (std::string::npos != pos) {
-    correctedto[pos] = '\\';
-    pos = correctedto.find("$");
-  }
-
-  return correctedto;
+bool HTTPSEverywhereService::ShouldHTTPSERedirect(
+    const uint64_t& request_identifier) {
+  return redirects_counter_.GetCount(request_identifier) <
+         HTTPSE_URL_MAX_REDIRECTS_COUNT - 1;
 }
 
-void HTTPSEverywhereService::CloseDatabase() {
-  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  if (level_db_) {
-    delete level_db_;
-    level_db_ = nullptr;
-  }
+void HTTPSEverywhereService::AddHTTPSEUrlToRedirectList(
+    const uint64_t& request_identifier) {
+  // Adding redirects count for the current request
+  redirects_counter_.Increment(request_identifier);
 }
 
 // static
@@ -10,16 +10,13 @@
 #include <string>
 #include <vector>
 
+#include "base/containers/flat_map.h"
 #include "base/files/file_path.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
-#include "base/synchronization/lock.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
 #include "brave/components/brave_shields/browser/https_everywhere_recently_used_cache.h"
-
-namespace leveldb {
-class DB;
-}
+#include "brave/components/brave_shields/browser/https_everywhere_redirects_counter.h"
 
 class HTTPSEverywhereServiceTest;
 
@@ -31,17 +28,7 @@ extern const char kHTTPSEverywhereComponentName[];
 extern const char kHTTPSEverywhereComponentId[];
 extern const char kHTTPSEverywhereComponentBase64PublicKey[];
 
-struct HTTPSE_REDIRECTS_COUNT_ST {
- public:
-  HTTPSE_REDIRECTS_COUNT_ST(uint64_t request_identifier,
-                            unsigned int redirects):
-    request_identifier_(request_identifier),
-    redirects_(redirects) {
-  }
-
-  uint64_t request_identifier_;
-  unsigned int redirects_;
-};
+class HTTPSERuleset;
 
 class HTTPSEverywhereService : public BaseBraveShieldsService,
                          public base::SupportsWeakPtr<HTTPSEverywhereService> {
@@ -51,6 +38,9 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
   bool GetHTTPSURL(const GURL* url,
                    const uint64_t& request_id,
                    std::string* new_url);
+  // Returns true if the result for |url| is known without consulting the
+  // rulesets. |cached_url| is left empty when the host is known to have no
+  // rules.
   bool GetHTTPSURLFromCacheOnly(const GURL* url,
                                 const uint64_t& request_id,
                                 std::string* cached_url);
@@ -63,9 +53,7 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
 
   void AddHTTPSEUrlToRedirectList(const uint64_t& request_id);
   bool ShouldHTTPSERedirect(const uint64_t& request_id);
-  std::string ApplyHTTPSRule(const std::string& originalUrl,
-      const std::string& rule);
-  std::string CorrecttoRuleToRE2Engine(const std::string& to);
+  void RecordCacheHitRate();
 
  private:
   friend class ::HTTPSEverywhereServiceTest;
@@ -77,14 +65,27 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
       const std::string& component_id,
       const std::string& component_base64_public_key);
 
-  void CloseDatabase();
+  // Compiled rulesets keyed by the reversed lookup domain (com.foo.*), built
+  // once from the component's leveldb when it is installed. Domains whose
+  // leveldb values are the same JSON share one compiled ruleset.
+  struct Rulesets {
+    Rulesets();
+    ~Rulesets();
+
+    std::vector<std::unique_ptr<HTTPSERuleset>> compiled;
+    base::flat_map<std::string, const HTTPSERuleset*> by_domain;
+
+    DISALLOW_COPY_AND_ASSIGN(Rulesets);
+  };
 
   void InitDB(const base::FilePath& install_dir);
 
-  base::Lock httpse_get_urls_redirects_count_mutex_;
-  std::vector<HTTPSE_REDIRECTS_COUNT_ST> httpse_urls_redirects_count_;
+  HTTPSERedirectsCounter redirects_counter_;
+  // Rewritten URLs keyed by the original URL spec.
   HTTPSERecentlyUsedCache<std::string> recently_used_cache_;
-  leveldb::DB* level_db_;
+  // Hosts for which no ruleset exists.
+  HTTPSERecentlyUsedCache<bool> hosts_without_rules_cache_;
+  std::unique_ptr<Rulesets> rulesets_;
 
   SEQUENCE_CHECKER(sequence_checker_);
   DISALLOW_COPY_AND_ASSIGN(HTTPSEverywhereService);
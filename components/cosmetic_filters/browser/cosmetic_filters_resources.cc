@@ -5,8 +5,10 @@
 
 #include "brave/components/cosmetic_filters/browser/cosmetic_filters_resources.h"
 
+#include <iterator>
 #include <utility>
 
+#include "base/containers/flat_map.h"
 #include "base/json/json_reader.h"
 #include "base/optional.h"
 #include "base/values.h"
@@ -16,6 +18,24 @@
 
 namespace cosmetic_filters {
 
+namespace {
+
+mojom::CosmeticResourcesPtr GetUrlCosmeticResourcesOnTaskRunner(
+    brave_shields::AdBlockService* ad_block_service,
+    const std::string& url) {
+  scoped_refptr<const brave_shields::SharedCosmeticResources> shared_resources =
+      ad_block_service->SharedUrlCosmeticResources(url);
+  const brave_shields::CosmeticResources& resources = shared_resources->data;
+  return mojom::CosmeticResources::New(
+      resources.hide_selectors,
+      base::flat_map<std::string, std::vector<std::string>>(
+          resources.style_selectors.begin(), resources.style_selectors.end()),
+      resources.exceptions, resources.injected_script, resources.generichide,
+      resources.force_hide_selectors);
+}
+
+}  // namespace
+
 CosmeticFiltersResources::CosmeticFiltersResources(
     HostContentSettingsMap* settings_map,
     brave_shields::AdBlockService* ad_block_service)
@@ -32,13 +52,15 @@ void CosmeticFiltersResources::HiddenClassIdSelectors(
   base::Optional<base::Value> input_value = base::JSONReader::Read(input);
   if (!input_value || !input_value->is_dict()) {
     // Nothing to work with
-    std::move(callback).Run(base::Value());
+    std::move(callback).Run(std::vector<std::string>(),
+                            std::vector<std::string>());
 
     return;
   }
   base::DictionaryValue* input_dict;
   if (!input_value->GetAsDictionary(&input_dict)) {
-    std::move(callback).Run(base::Value());
+    std::move(callback).Run(std::vector<std::string>(),
+                            std::vector<std::string>());
 
     return;
   }
@@ -65,25 +87,38 @@ void CosmeticFiltersResources::HiddenClassIdSelectors(
 
   ad_block_service_->GetTaskRunner()->PostTaskAndReplyWithResult(
       FROM_HERE,
-      base::BindOnce(&brave_shields::AdBlockService::HiddenClassIdSelectors,
-                     base::Unretained(ad_block_service_), classes, ids,
-                     exceptions),
+      base::BindOnce(
+          &CosmeticFiltersResources::GetHiddenClassIdSelectorsOnTaskRunner,
+          base::Unretained(ad_block_service_), std::move(classes),
+          std::move(ids), exceptions),
       base::BindOnce(&CosmeticFiltersResources::HiddenClassIdSelectorsOnUI,
                      weak_factory_.GetWeakPtr(), std::move(callback)));
 }
 
+// static
+CosmeticFiltersResources::HiddenClassIdSelectorsResult
+CosmeticFiltersResources::GetHiddenClassIdSelectorsOnTaskRunner(
+    brave_shields::AdBlockService* ad_block_service,
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& exceptions) {
+  HiddenClassIdSelectorsResult selectors;
+  ad_block_service->HiddenClassIdSelectors(
+      classes, ids, exceptions, &selectors.first, &selectors.second);
+  return selectors;
+}
+
 void CosmeticFiltersResources::HiddenClassIdSelectorsOnUI(
     HiddenClassIdSelectorsCallback callback,
-    base::Optional<base::Value> resources) {
-  std::move(callback).Run(resources ? std::move(resources.value())
-                                    : base::Value());
+    HiddenClassIdSelectorsResult selectors) {
+  std::move(callback).Run(std::move(selectors.first),
+                          std::move(selectors.second));
 }
 
 void CosmeticFiltersResources::UrlCosmeticResourcesOnUI(
     UrlCosmeticResourcesCallback callback,
-    base::Optional<base::Value> resources) {
-  std::move(callback).Run(resources ? std::move(resources.value())
-                                    : base::Value());
+    mojom::CosmeticResourcesPtr resources) {
+  std::move(callback).Run(std::move(resources));
 }
 
 void CosmeticFiltersResources::ShouldDoCosmeticFiltering(
@@ -102,7 +137,7 @@ void CosmeticFiltersResources::UrlCosmeticResources(
     UrlCosmeticResourcesCallback callback) {
   ad_block_service_->GetTaskRunner()->PostTaskAndReplyWithResult(
       FROM_HERE,
-      base::BindOnce(&brave_shields::AdBlockService::UrlCosmeticResources,
+      base::BindOnce(&GetUrlCosmeticResourcesOnTaskRunner,
                      base::Unretained(ad_block_service_), url),
       base::BindOnce(&CosmeticFiltersResources::UrlCosmeticResourcesOnUI,
                      weak_factory_.GetWeakPtr(), std::move(callback)));
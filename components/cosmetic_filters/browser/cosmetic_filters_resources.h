@@ -8,11 +8,10 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/memory/weak_ptr.h"
-#include "base/optional.h"
-#include "base/values.h"
 #include "brave/components/cosmetic_filters/common/cosmetic_filters.mojom.h"
 
 class HostContentSettingsMap;
@@ -53,11 +52,22 @@ class CosmeticFiltersResources final
                             UrlCosmeticResourcesCallback callback) override;
 
  private:
+  // The selectors from the default and regional lists, and those from custom
+  // filters.
+  using HiddenClassIdSelectorsResult =
+      std::pair<std::vector<std::string>, std::vector<std::string>>;
+
+  static HiddenClassIdSelectorsResult GetHiddenClassIdSelectorsOnTaskRunner(
+      brave_shields::AdBlockService* ad_block_service,
+      const std::vector<std::string>& classes,
+      const std::vector<std::string>& ids,
+      const std::vector<std::string>& exceptions);
+
   void HiddenClassIdSelectorsOnUI(HiddenClassIdSelectorsCallback callback,
-                                  base::Optional<base::Value> resources);
+                                  HiddenClassIdSelectorsResult selectors);
 
   void UrlCosmeticResourcesOnUI(UrlCosmeticResourcesCallback callback,
-                                base::Optional<base::Value> resources);
+                                mojom::CosmeticResourcesPtr resources);
 
   HostContentSettingsMap* settings_map_;             // Not owned
   brave_shields::AdBlockService* ad_block_service_;  // Not owned
@@ -55,9 +55,12 @@ class CosmeticFiltersJSHandler {
   void OnShouldDoCosmeticFiltering(base::OnceClosure callback,
                                    bool enabled,
                                    bool first_party_enabled);
-  void OnUrlCosmeticResources(base::OnceClosure callback, base::Value result);
-  void CSSRulesRoutine(base::DictionaryValue* resources_dict);
-  void OnHiddenClassIdSelectors(base::Value result);
+  void OnUrlCosmeticResources(base::OnceClosure callback,
+                              mojom::CosmeticResourcesPtr resources);
+  void CSSRulesRoutine(const mojom::CosmeticResources& resources);
+  void OnHiddenClassIdSelectors(
+      const std::vector<std::string>& selectors,
+      const std::vector<std::string>& force_hide_selectors);
 
   content::RenderFrame* render_frame_;
   mojo::Remote<cosmetic_filters::mojom::CosmeticFiltersResources>
@@ -66,7 +69,7 @@ class CosmeticFiltersJSHandler {
   bool enabled_1st_party_cf_;
   std::vector<std::string> exceptions_;
   GURL url_;
-  std::unique_ptr<base::DictionaryValue> resources_dict_;
+  mojom::CosmeticResourcesPtr resources_;
 };
 
 // static
@@ -126,10 +126,10 @@ void SpeedreaderRewriterService::OnLoadStylesheet(std::string stylesheet) {
 }
 
 void SpeedreaderRewriterService::OnLoadDATFileData(
-    GetDATFileDataResult result) {
+    std::unique_ptr<speedreader::SpeedReader> result) {
   VLOG(2) << "Speedreader loaded from DAT file";
-  if (result.first)
-    speedreader_ = std::move(result.first);
+  if (result)
+    speedreader_ = std::move(result);
 }
 
 }  // namespace speedreader
@@ -0,0 +1,49 @@
+/* Copyright (c) 2021 The Brave Software Team. Distributed under the MPL2
+ * license. This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/test/base/testing_brave_component_updater_delegate.h"
+
+#include "base/notreached.h"
+#include "base/threading/thread_task_runner_handle.h"
+
+TestingBraveComponentUpdaterDelegate::TestingBraveComponentUpdaterDelegate() =
+    default;
+
+TestingBraveComponentUpdaterDelegate::~TestingBraveComponentUpdaterDelegate() =
+    default;
+
+void TestingBraveComponentUpdaterDelegate::Register(
+    const std::string& component_name,
+    const std::string& component_base64_public_key,
+    base::OnceClosure registered_callback,
+    brave_component_updater::BraveComponent::ReadyCallback ready_callback) {}
+
+bool TestingBraveComponentUpdaterDelegate::Unregister(
+    const std::string& component_id) {
+  return true;
+}
+
+void TestingBraveComponentUpdaterDelegate::OnDemandUpdate(
+    const std::string& component_id) {}
+
+void TestingBraveComponentUpdaterDelegate::AddObserver(
+    ComponentObserver* observer) {}
+
+void TestingBraveComponentUpdaterDelegate::RemoveObserver(
+    ComponentObserver* observer) {}
+
+scoped_refptr<base::SequencedTaskRunner>
+TestingBraveComponentUpdaterDelegate::GetTaskRunner() {
+  return base::ThreadTaskRunnerHandle::Get();
+}
+
+const std::string TestingBraveComponentUpdaterDelegate::locale() const {
+  return "en";
+}
+
+PrefService* TestingBraveComponentUpdaterDelegate::local_state() {
+  NOTREACHED();
+  return nullptr;
+}